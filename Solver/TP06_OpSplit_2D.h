@@ -0,0 +1,547 @@
+/***************************************************************
+
+TP06_OpSplit_2D.h
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/* Header file for TP06 in 2D with isotropic diffusion */
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* the values below are the defaults for the run time settings in */
+/* config_2D, and can be changed with a config file or on the command line */
+
+#define ROWS            400      //340
+#define COLUMNS         400
+#define NUM_STATES      20      /* number of states in u array */
+#define NUM_ITERATIONS  30000   /* maximum duration of simulation (60000 is 6s) */
+//#define NUM_POINTS      100   /* Length of cable */
+#define DT              0.10    /* maximum timestep (ms) */
+#define DX              0.25    /* 0.25 mm : Assume dx = dy */
+#define DIFFUSION       0.2     /* mm2/ms :isotropic diffusion */
+#define VMOFFSET        1001.0  /* offset for lookup table */
+#define GAIN            10.0    /* gain for lookup table */
+#define NUM_LOOKUP      40      /* number of variables in lookup table*/
+#define NUM_EXP_GATES   11      /* gates in the gate table, see create_TP06_lookup_OpSplit_2D.c */
+#define LOOKUP_VMIN     -100    /* Vm of the first bin of the gate table (mV) */
+#define LOOKUP_BINS     201     /* 1 mV bins in the gate table */
+#define NUM_VTERMS      7       /* terms in the voltage table, see create_TP06_lookup_OpSplit_2D.c */
+#define LOOKUP_VLOW     -150.0  /* Vm of the first point of the voltage table (mV) */
+#define LOOKUP_VSTEP    0.1     /* spacing of the voltage table (mV) */
+#define LOOKUP_VPOINTS  3001    /* points in the voltage table */
+#define PARAMETER_SET   4       /* TP06 parameter set 1..NUM_PARAMETER_SETS, set with -par */
+#define NUM_PARAMETER_SETS 4
+#define CELL_ATP        6.8     /* intracellular ATP (mM) where there is no ATP map */
+#define NUM_CELLMAPS    4       /* per-node parameter maps, see cellmap_2D.c */
+#define MAX_CELL_CLASSES 65535  /* distinct combinations of the map values */
+#define NUM_PARAMS      50      /* number of cell model parameters */
+#define VOLTAGE_STEPS   2001    /* number of voltage steps in lookup table */
+#define CM              1.0     /* Membrane capacitance (uF/cm2) */
+#define OMP_CHUNK       400     /* nodes handed to each thread at a time (one row) */
+#define ALIGNMENT       64      /* alignment (bytes) of state arrays */
+#define SIMD_BLOCK      8       /* nodes advanced together by the block kernel */
+#define GATE_REFRESH    100     /* steps a node can be held at rest (-gate) before it is solved in full again */
+
+/* scar models, selected with -scar at run time, see initialise_geometry_2D.c */
+#define SCAR_CONTINUOUS 0       /* D as read, scar is tissue with D = 0 */
+#define SCAR_SMOOTH     1       /* D as read, scar is a no-flux boundary */
+#define SCAR_THRESHOLD  2       /* uniform D, scar is a no-flux boundary */
+#define SCAR_DMIN       0.025   /* D at or below which a grid point is scar */
+#define SCAR_DTHRESHOLD 0.1     /* D in the tissue with SCAR_THRESHOLD */
+#define SCAR_MODEL      SCAR_CONTINUOUS
+
+/* scar from a Gaussian random field, see grf_2D.c */
+#define GRF_LENGTH      0.0     /* length scale (grid points), 0 to read DIFFUSIONFILE */
+#define GRF_SEED        1
+#define GRF_MAXD        0.1     /* D in normal tissue */
+#define GRF_MIND        0.0     /* D below which tissue is scar */
+#define GRF_RINNER      50.0    /* radius of the scar core (grid points) */
+#define GRF_ROUTER      120.0   /* radius of the border zone */
+#define GRF_SLOPE       -0.075  /* slope of the sigmoid */
+
+/* ionic kernels, selected with -kernel at run time */
+#define KERNEL_SCALAR   0       /* calculate_TP06_current_OpSplit, one node at a time */
+#define KERNEL_SIMD     1       /* calculate_TP06_current_OpSplit_block, SIMD_BLOCK nodes at a time */
+
+#define S1BCL           400.0   /* basic cycle length for pacing (ms) */
+#define NUMS1BEATS      3       /* number of S1 beats */
+#define NUMS2BEATS      4       /* number of extra beats delivered at ERP */
+#define S2START         900.0   /* S2 beats are delivered between these times (ms) */
+#define S2END           2100.0
+#define STIMROW         75      /* centre of the stimulating electrode */
+#define STIMCOL         75
+#define STIMRADIUS      5       /* radius of the stimulating electrode (grid points) */
+#define EGINTERVAL      1.0     /* time between electrogram samples (ms) */
+#define SNAPINTERVAL    10.0    /* time between snapshots of Vm (ms) */
+#define PROBES          "2:2,76:100,76:200,113:350,151:100,2:200"  /* row:col of each electrogram probe */
+#define MAX_PROBES      16
+//define S1S2            360.0   /* S1S2 interval (ms) 500 ms for SR, 400 for cAF*/
+//#define DECREMENT       20.0    /* decrement for S1 beats */
+
+/* Macros for numerical recipes routines */
+#define FREE_ARG       	char*
+#define NR_END         	1
+
+/* diffusion file, text or binary (see diffusion_file_2D.c) */
+#define DIFFUSIONFILE   "DiffusionCoefficient.txt"
+#define DIFFUSION_MAGIC "TP06DIFF"
+#define DIFFUSION_VERSION 1
+
+typedef struct
+{
+  char magic[8];                /* DIFFUSION_MAGIC */
+  int32_t version;              /* DIFFUSION_VERSION */
+  int32_t nrows, ncols;
+  int32_t reserved;
+  uint64_t hash;                /* FNV-1a hash of the data */
+} diffusion_header;
+
+/* Macros for output */
+#define OUTPUTFILEROOT  "TP06_2D_"
+#define STFFILEROOT     "STFfiles/TP06_2D_"
+#define SNAPSHOTFILE    "STFfiles/TP06_2D_snapshots.bin"
+
+/* snapshots of Vm, format selected with -snapshots at run time */
+#define SNAPSHOT_STF    0       /* one gzipped text stf file per snapshot */
+#define SNAPSHOT_FLOAT  1       /* binary, single precision */
+#define SNAPSHOT_INT16  2       /* binary, Vm * SNAPSHOT_SCALE as 16 bit integer */
+#define SNAPSHOT_SCALE  100.0   /* 0.01 mV, the precision of the stf files */
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_MAGIC  "TP06SNAP"
+#define SNAPSHOT_INDEX_MAGIC "INDX"
+
+/* checkpointing */
+/* read/write times should be multiples  f 5 ms */
+#define CHKPTROOT 		    "checkpoint"
+#define CHKPT_READ	        0
+#define CHKPT_READ_TIME     200000 // 4000 ms
+#define CHKPT_WRITE	        0
+#define CHKPT_WRITE_TIME    200000 // 4000 ms
+#define CHKPT_VERSION       3
+#define CHKPT_KEEP          2      // checkpoints kept with -checkpoint
+#define SEEDFILE            "seed.out" // single cell state written by -makeseed
+#define CHKPT_MAGIC         "TP06CHKP"
+#define CHKPT_LATEST        -2     // -restart latest
+
+/* run time settings, see config_2D.c */
+#define CONFIG_STRLEN   256
+
+typedef struct
+{
+  int nrows, ncols;
+  int numIterations;
+  int scar;                     /* SCAR_CONTINUOUS, SCAR_SMOOTH or SCAR_THRESHOLD */
+  double dt, dx;
+  double bcl;                   /* pacing */
+  int numS1Beats, numS2Beats;
+  double s2Start, s2End;
+  int stimRow, stimCol, stimRadius;
+  double egInterval, snapInterval;  /* output */
+  int numProbes;                    /* electrogram probes, set with -probes row:col,row:col,... */
+  int probeRow[MAX_PROBES], probeCol[MAX_PROBES];
+  char diffusionFile[CONFIG_STRLEN];
+  char outputRoot[CONFIG_STRLEN];
+  char stfRoot[CONFIG_STRLEN];
+  char snapshotFile[CONFIG_STRLEN];
+  char chkptRoot[CONFIG_STRLEN];
+  int chkptRead, chkptReadTime;     /* checkpoints */
+  int chkptWrite, chkptWriteTime;
+  double chkptInterval;             /* ms, 0 for none */
+  int keep;
+  int restart;                      /* checkpoint to start from, -1 for none */
+  int threads;                      /* 0 for the OpenMP default */
+  int kernel;                       /* KERNEL_SCALAR or KERNEL_SIMD */
+  int parameterSet;                 /* TP06 parameter set, 1..NUM_PARAMETER_SETS */
+  double gate;                      /* tolerance for holding nodes at rest, 0 for off */
+  int snapshots;                    /* SNAPSHOT_STF, SNAPSHOT_FLOAT or SNAPSHOT_INT16 */
+  char seedFile[CONFIG_STRLEN];     /* initial state, empty for none */
+  int seedNode;
+  char seedOut[CONFIG_STRLEN];
+  int makeSeed;                     /* beats to pace a single cell for, 0 for none */
+  char ensemble[CONFIG_STRLEN];     /* list of diffusion files to run, empty for one run */
+  int jobs;                         /* samples in the ensemble run at once */
+  int batch;                        /* samples advanced together in lock-step, 1 for none */
+  double grf;                       /* length scale of a GRF scar, 0 to read diffusionFile */
+  int grfSeed;
+  int grfRemove;                    /* remove tissue at random as in DiffusionCoefficient_random.txt */
+  char grfOut[CONFIG_STRLEN];       /* file to write the GRF scar to, empty for none */
+  char gNaMap[CONFIG_STRLEN];       /* per-node parameter maps, empty for none */
+  char gKsMap[CONFIG_STRLEN];
+  char gCaLMap[CONFIG_STRLEN];
+  char atpMap[CONFIG_STRLEN];
+} config_2D;
+
+extern config_2D config;
+
+void default_config_2D( config_2D *c );
+int set_config_2D( config_2D *c, char *name, char *value );
+int read_config_2D( config_2D *c, char *fname );
+int parse_config_args_2D( config_2D *c, int argc, char **argv );
+void write_config_2D( config_2D *c, FILE *fp );
+
+/* The four parameter sets of the TP06 paper (ten Tusscher and
+   Panfilov 2006), with different GKr, GKs, GpCa, GpK and tau_f for
+   Vm >= 0. Set 2 is equivalent to the default epicardial cell. The
+   kernels are compiled once for each set, with the parameters as
+   constants, and the set is chosen at run time with -par */
+typedef struct
+{
+  double Gkr, Gks, GpCa, GpK;
+  double tau_f_multiplier;
+} tp06_par;
+
+static const tp06_par tp06_parameter_set[NUM_PARAMETER_SETS] =
+{
+  { 0.134, 0.270, 0.0619, 0.0730,  0.6 },
+  { 0.153, 0.392, 0.1238, 0.0146,  1.0 },
+  { 0.172, 0.441, 0.3714, 0.0073,  1.5 },
+  { 0.172, 0.441, 0.8666, 0.00219, 2.0 }
+};
+
+#if defined(__GNUC__)
+#define TP06_INLINE static inline __attribute__((always_inline))
+#else
+#define TP06_INLINE static inline
+#endif
+
+/* lookup tables, see create_TP06_lookup_OpSplit_2D.c */
+/* the gate table is single precision if built with -DLOOKUP_FLOAT */
+#ifdef LOOKUP_FLOAT
+typedef float lookup_t;
+#else
+typedef double lookup_t;
+#endif
+
+/* entries in a record of the gate table, inf and exp(-dt/tau) of */
+/* each gate padded to whole cache lines */
+#define LOOKUP_RECORD   ((int) ((2 * NUM_EXP_GATES * sizeof(lookup_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT / sizeof(lookup_t)))
+
+/* entries in a record of the voltage table, each term and its change */
+/* to the next point, padded to whole cache lines */
+#define LOOKUP_VRECORD  ((int) ((2 * NUM_VTERMS * sizeof(lookup_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT / sizeof(lookup_t)))
+
+typedef struct
+{
+  double **var;                 /* var[i][Vindex], inf and tau of the gates */
+  double dt;                    /* time step the gate table was made for */
+  int par;                      /* and the parameter set, 1..NUM_PARAMETER_SETS */
+  int numK;                     /* sub-steps dt/k in the gate table, k = 1..numK */
+  lookup_t *gate;               /* a record for each sub-step and voltage bin */
+  lookup_t *volt;               /* a record for each point of the voltage table */
+} lookup_2D;
+
+/* sub-step k of the gate table for a time step of dt/k */
+static inline int lookup_substep_2D( const lookup_2D *lk, double dt )
+{
+  int k = (int) (lk->dt / dt + 0.5);
+
+  return (k < 1) ? 1 : ((k > lk->numK) ? lk->numK : k);
+}
+
+/* record of the gate table for sub-step k and the voltage bin of Vm */
+static inline const lookup_t *lookup_record_2D( const lookup_2D *lk, int k, double Vm )
+{
+  int bin = (int) floor(Vm) - LOOKUP_VMIN;
+
+  bin = (bin < 0) ? 0 : ((bin >= LOOKUP_BINS) ? LOOKUP_BINS - 1 : bin);
+  return &lk->gate[((long) (k - 1) * LOOKUP_BINS + bin) * LOOKUP_RECORD];
+}
+
+/* terms of the voltage table at Vm, interpolated between the points */
+/* either side, which are both held in one record. Beyond the ends of */
+/* the table the terms are extrapolated from the end records */
+static inline void lookup_volt_2D( const lookup_2D *lk, double Vm, double *term )
+{
+  const lookup_t *rec;
+  double x, xi;
+  int i, t;
+
+  x = (Vm - LOOKUP_VLOW) / LOOKUP_VSTEP;
+  xi = (x < 0.0) ? 0.0 : ((x > LOOKUP_VPOINTS - 2) ? LOOKUP_VPOINTS - 2 : x);
+  i = (int) xi;
+  x -= i;
+  rec = &lk->volt[(long) i * LOOKUP_VRECORD];
+  for (t = 0; t < NUM_VTERMS; t++)
+    term[t] = rec[t] + x * rec[NUM_VTERMS + t];
+}
+
+/* ensemble of simulations, see ensemble_2D.c and batch_2D.c */
+int run_ensemble_2D( config_2D *c, lookup_2D *lookup );
+int run_batch_2D( config_2D *c, lookup_2D *lookup, char **list, int S );
+
+/* model state stored as a structure of arrays */
+/* var[m][n] holds state variable m at node n, for m = 1..NUM_STATES, n = 1..N */
+/* Vm is the same array as var[1] */
+typedef struct
+{
+  int N;
+  double *Vm;
+  double *var[NUM_STATES + 1];
+} state_2D;
+
+/* cell parameters that vary from node to node, see cellmap_2D.c */
+/* nodes with the same parameters form a class, and class 0 is the */
+/* cell of the parameter set with no scaling and ATP of CELL_ATP */
+typedef struct
+{
+  int N;
+  int numClasses;
+  unsigned short *cls;          /* class of node n, n = 1..N */
+  double *gNa, *gKs, *gCaL;     /* scaling of GNa, GKs and GCaL for each class */
+  double *atp;                  /* intracellular ATP (mM) for IKatp for each class */
+} cellmap_2D;
+
+/* diffusion operator on the structured lattice */
+/* lattice arrays have a ring of ghost sites, and site (row, col) for */
+/* row = 0..nrows+1, col = 0..ncols+1 is held at index row*stride + col */
+/* in batch mode each site holds lanes samples, see batch_2D.c */
+typedef struct
+{
+  int nrows, ncols, stride;
+  int lanes;                    /* samples interleaved at each site, 1 for one run */
+  int N;
+  int *site;                    /* site[n] is the lattice index of node n */
+  double *w0;                   /* weight of the site itself */
+  double *w2, *w4, *w6, *w8;    /* weights of the neighbours, 0 for no-flux */
+  double *Vlat, *Vnew;          /* voltage on the lattice before and after a sweep */
+} stencil_2D;
+
+/* forward declaration of all functions used */
+
+/* PDE solver */
+int initialise_geometry_2D( int **geom, int nrows, int ncols, int **nneighb, double *D, int scar );
+int probe_nodes_2D( int **geom, int nrows, int ncols, int *node );
+void make_grf_2D( double *f, int nrows, int ncols, double lengthScale, uint64_t seed );
+void make_scar_2D( double *D, int nrows, int ncols, double lengthScale, uint64_t seed, int removal );
+int write_scar_2D( char *fname, double *D, int nrows, int ncols );
+void read_diffusion_2D( char *fname, int nrows, int ncols, double *D );
+void read_grid_2D( char *fname, char *name, int nrows, int ncols, double *D );
+int write_diffusion_bin_2D( char *fname, double *D, int nrows, int ncols );
+void initialise_variables_2D( state_2D *u, int N );
+void seed_variables_2D( state_2D *u, int N, double *U );
+void pace_cell_2D( double *U, lookup_2D *lookup, double bcl, int numBeats );
+void initialise_spiral_2D( state_2D *u, int N, int ny, int nx );
+//void initialise_diffusion_2D( double *D, int nrows, int ncols );
+
+int create_TP06_lookup_OpSplit_2D( double **lookup );
+lookup_2D *create_lookup_2D( double dt, int par );
+void free_lookup_2D( lookup_2D *lk );
+double calculate_TP06_current_OpSplit( double *U, double dt, lookup_2D *lookup, const cellmap_2D *map, int cls,
+                                       double stimCurrent );
+void calculate_TP06_current_OpSplit_block( double **Ub, int nb, const double *dt, const int *active,
+                                           lookup_2D *lookup, const cellmap_2D *map, int cls,
+                                           const double *stimCurrent, double *Iion );
+int validate_TP06_block_kernel( lookup_2D *lookup, double tol );
+stencil_2D *create_stencil_2D( int **geom, int nrows, int ncols, int **nneighb, double *D, int N, int scar );
+stencil_2D *create_batch_stencil_2D( stencil_2D **sample, int S );
+void free_stencil_2D( stencil_2D *st );
+void diffusion_2D( stencil_2D *st, double *Vin, double *Vout, double half_dt );
+void diffusion_2D_step( stencil_2D *st, double *Vm, double *new_Vm, double *old_Vm, double *dVdt, double half_dt );
+int free_arrays( double **u, int N, int num_parameters, double **lookup, int voltage_steps, int num_lookup );
+void writeData( char *fname, double *dataToWrite, int **geom, int nrows, int ncols );
+
+/* model state */
+state_2D *create_state_2D( int N );
+void free_state_2D( state_2D *u );
+
+/* per-node cell parameters */
+cellmap_2D *create_cellmap_2D( int **geom, int nrows, int ncols, int N );
+void free_cellmap_2D( cellmap_2D *map );
+int group_nodes_2D( cellmap_2D *map, int *list, int num, int *blockStart, int blockSize );
+
+/* binary snapshot file, see snapshot_2D.c for the layout */
+typedef struct
+{
+  char magic[8];                /* SNAPSHOT_MAGIC */
+  int32_t version;
+  int32_t nx, ny;
+  int32_t encoding;             /* SNAPSHOT_FLOAT or SNAPSHOT_INT16 */
+  int32_t compression;          /* 1 if the data are deflated with zlib */
+  int32_t reserved;
+  double scale;                 /* SNAPSHOT_SCALE */
+} snapshot_header;
+
+typedef struct
+{
+  int32_t label;                /* number used in the stf file name */
+  int32_t nbytes;               /* bytes of data that follow */
+  double time;                  /* ms */
+} snapshot_frame;
+
+typedef struct
+{
+  int32_t label;
+  int32_t nbytes;
+  double time;
+  int64_t offset;               /* file position of the snapshot_frame */
+} snapshot_index;
+
+typedef struct
+{
+  int64_t offset;               /* file position of the index */
+  int32_t count;                /* number of snapshots */
+  char magic[4];                /* SNAPSHOT_INDEX_MAGIC */
+} snapshot_trailer;
+
+typedef struct
+{
+  FILE *fp;
+  int nx, ny, encoding;
+  int count, size;              /* snapshots written, and room in index */
+  snapshot_index *index;
+  void *raw, *packed;           /* data before and after compression */
+  long rawBytes, packedBytes;
+} snapshot_file;
+
+snapshot_file *open_snapshots_2D( char *fname, int nx, int ny, int encoding );
+snapshot_file *reopen_snapshots_2D( char *fname, int nx, int ny, int encoding, long offset );
+void write_snapshot_2D( snapshot_file *sf, double *Vm, int **geomarray, int label, double time );
+void close_snapshots_2D( snapshot_file *sf );
+
+/* checkpointing */
+/* the arrays belong to main, and the scalars are copied in before */
+/* writing and out after reading */
+typedef struct
+{
+  int N, nrows, ncols, numBeats;
+  int scar;                     /* scar model */
+  int t, stfcount;
+  double time, nextStim;
+  uint64_t dHash;               /* hash of DIFFUSIONFILE */
+  long egOffset, snapOffset;    /* bytes of output written, -1 if not known */
+  state_2D *u;
+  double *new_Vm, *old_Vm, *dVdt, *dVreac;
+  double **upStrokeTime, **downStrokeTime;
+  int *beat, *frozen;
+} checkpoint_2D;
+
+typedef struct
+{
+  char magic[8];                /* CHKPT_MAGIC */
+  int32_t version;              /* CHKPT_VERSION */
+  int32_t N, nrows, ncols, numStates, numBeats;
+  int32_t t, stfcount;
+  int32_t scar;                 /* 0 (SCAR_CONTINUOUS) in earlier files */
+  double time, nextStim;
+  uint64_t dHash;
+  int64_t egOffset, snapOffset; /* not in version 2 files */
+} checkpoint_header;
+
+uint64_t hash_file_2D( char *fname );
+uint64_t hash_data_2D( void *data, long size );
+long checkpoint_size( checkpoint_2D *c );
+void checkpoint_pack( checkpoint_2D *c, char *buf );
+int checkpoint_flush( char *buf, long size, int count );
+int checkpoint_write( checkpoint_2D *c, int count );
+int checkpoint_read( checkpoint_2D *c, int count );
+int checkpoint_latest( void );
+FILE *checkpoint_append( char *fname, long offset );
+int checkpoint_seed_write( char *fname, double *U, double time );
+int checkpoint_seed_read( char *fname, int node, double *U );
+
+/* output queued for the background writer thread */
+#define WRITER_QUEUE    4       /* jobs that can be waiting to be written */
+#define WRITER_ELECTROGRAM 1
+#define WRITER_SNAPSHOT 2
+#define WRITER_CHECKPOINT 3
+
+typedef struct
+{
+  int type;                     /* WRITER_ELECTROGRAM, WRITER_SNAPSHOT or WRITER_CHECKPOINT */
+  int label;                    /* number used in the stf or checkpoint file name */
+  double time;                  /* ms */
+  double value[MAX_PROBES];     /* electrogram values */
+  int numValues;
+  double *Vm;                   /* copy of Vm for a snapshot, [1..N] */
+} writer_job;
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t notEmpty, notFull;
+  writer_job job[WRITER_QUEUE];
+  int head, count, done;        /* first job waiting, jobs waiting, no more to come */
+  int N, nrows, ncols, snapshots;
+  int **geom;
+  FILE *egPtr;
+  snapshot_file *snap;
+  char *chkBuf;                 /* packed checkpoint waiting to be written */
+  long chkSize;
+  int chkBusy;                  /* chkBuf is in use */
+  int keep, numKept;            /* checkpoints kept, and written so far */
+  int *kept;                    /* counts of the checkpoints kept */
+} writer_2D;
+
+writer_2D *create_writer_2D( int N, int **geom, int nrows, int ncols, FILE *egPtr, snapshot_file *snap, int snapshots, int keep );
+void queue_electrogram_2D( writer_2D *w, double time, double *value, int num );
+void queue_snapshot_2D( writer_2D *w, double *Vm, int label, double time );
+void queue_checkpoint_2D( writer_2D *w, checkpoint_2D *c, int count );
+void writer_offsets_2D( writer_2D *w, checkpoint_2D *c );
+void keep_checkpoint_2D( writer_2D *w, int count );
+void free_writer_2D( writer_2D *w );
+
+
+/* Numerical recipes routines */
+double *fvector( long nl, long nh );
+double *avector( long nl, long nh );
+int *ivector( long nl, long nh );
+int **imatrix( long nrl, long nrh, long ncl, long nch );
+double **fmatrix( long nrl, long nrh, long ncl, long nch );
+int ***i3dmatrix( long nrl, long nrh, long ncl, long nch, long ndl, long ndh);
+void free_ivector( int *m, long nl, long nh );
+void free_imatrix( int **m, long nrl, long nrh, long ncl, long nch );
+void free_fvector( double *m, long nl, long nh );
+void free_avector( double *m, long nl, long nh );
+void free_fmatrix( double **m, long nrl, long nrh, long ncl, long nch );
+void free_i3dmatrix( int ***m, long nrl, long nrh, long ncl, long nch, long ndl, long ndh );
+void nrerror( char error_text[] );
+
+int stfout_2D( double *Vm, int **geomarray, int stfcount, int nx, int ny );
+
+/* RGB file output */
+//int write_rgb( int nx, int ny, int N, double **u, int **geom, char *fname, int I, double iMax, double iMin );
+//void putbyte( FILE *outfile, unsigned char value );
+//void putshort( FILE *outfile, unsigned short value );
+//static int putlong( FILE *outfile, unsigned long value );
+
+/*** END ***/
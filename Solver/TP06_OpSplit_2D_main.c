@@ -0,0 +1,846 @@
+/********************************************************************
+
+ TP06_OpSplit_2D_main.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This program evaluates the TP06 model equations for a
+ 2D sheet, with rapid pacing.
+
+ The parameters for numerical solution are contained in the header file,
+ and can be changed at run time (see config_2D.c).
+ The PDE is solved using operator splitting, with a maximum dt
+ of 10 x DT as defined in the header file.
+  
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+double gate_node(int *frozen, double *rate, double dVreac, int quiet, double dVdt, double tol);
+
+int main(int argc, char **argv)
+{
+  /* constants */
+  int tmax;			                          // duration of simulation
+  const int num_states = NUM_STATES;        // number of states stored at each grid point
+  const int num_params = NUM_PARAMS;        // number of model parameters (inputs)
+  int nrows, ncols;
+  long RC;                                  // total number of grid points
+  const int V = 1;                          // index of membrane voltage
+
+  double dtlong;					                    // long time step for diffusion
+  double half_dtlong;		                    // half time step for diffusion
+  //const double D = DIFFUSION;				      // diffusion coefficient
+
+  /* variables */
+  int N;
+  int **geom, **nneighb;    				        // arrays to store geometry and nearest neighbours
+  int t, n, m, dummy;						            // array indices
+  int k, ko, kmax;					                // parameters for adaptive timestep
+  int row, col;								              // array indices
+  int *celltype;							              // specify myocyte (1) or fibroblast (0)
+  int *excitable, *passive;                 // compacted lists of excitable and passive nodes
+  int numExcitable, numPassive, j;
+  cellmap_2D *cells;                        // per-node cell parameters
+  int *blockStart;                          // first excitable node of each block of a single class
+  int stfcount = 0;						              // index for stf output
+
+  double dtshort;							              // adaptive short time step for ODE solution
+  state_2D *u;                              // model state, one array per state variable
+  lookup_2D *lookup = NULL;                 // lookup tables
+  int lookupMade = 0;                       // lookup table made before an ensemble
+  double time = 0.0;
+  double timems = 0.0;
+  double stimCurrent = 0.0;
+  double *dVdt, *new_Vm, *old_Vm, *U;		    // arrays for storing state during updates
+  int numThreads;                           // number of threads for reaction step (0 = default)
+  int kernel;                               // ionic kernel used in the reaction step
+  int b, l, j0, nb, kblock, numBlocks;      // block and lane indices for the SIMD kernel
+  int contiguous;                           // nodes in a block are next to each other in u
+  double *Ub[NUM_STATES + 1];               // state of the nodes in a block
+  double Ulane[NUM_STATES + 1][SIMD_BLOCK]; // copy of the state when they are not
+  double Uold[NUM_STATES + 1][SIMD_BLOCK];  // state of the block before the reaction step
+  double laneDt[SIMD_BLOCK], laneStim[SIMD_BLOCK], laneIion[SIMD_BLOCK];
+  int laneK[SIMD_BLOCK], laneActive[SIMD_BLOCK];
+  int i;
+  double dV;
+  double *params;
+  double *D;                               // array to hold local diffusion coefficient
+  stencil_2D *stencil;                     // diffusion operator on the lattice
+  double gateTol;                          // tolerance for holding nodes at rest (0 for off)
+  int *frozen;                             // steps since a node at rest was solved in full, 0 if not at rest
+  double *dVreac;                          // change in Vm from the reaction at the last full solve
+  double gateErr = 0.0;                    // largest error in Vm from holding nodes at rest
+  double err;
+  int quiet;
+  long numSkipped = 0, numSolved = 0;      // reaction steps skipped and solved in full
+  int snapshots;                           // format of Vm snapshots
+  snapshot_file *snap = NULL;
+  writer_2D *writer;                       // background thread for output
+  double egValues[MAX_PROBES];             // electrogram values handed to the writer
+  int probeNode[MAX_PROBES], numProbes;    // node at each electrogram probe, 0 for none
+  checkpoint_2D chk;                       // solver state for checkpoints
+  int chkptSteps = 0;                      // time steps between checkpoints, 0 for none
+  int restart;                             // checkpoint to start from, -1 for none
+  FILE *cfgPtr;
+
+  double bcl;                              // basic cycle length for pacing
+  int numS1Beats;                          // number of S1 stimuli
+  int numS2Beats;                          // number of extra beats delivered after last S1
+  //const double s1s2 = S1S2;                // coupling interval to s2 stimulus
+  //const double decrement = DECREMENT;      // decrement in pacing interval with each stimulus
+  int s1Beat = 1;
+  int s2Beat = 1;
+  int radius;                              // radius of stimulating electrode
+  int radius2;
+  double nextStim = 0.0;                   // time of next stimulus in ms
+  int S1stimFlag = 0;
+  int S2stimFlag = 0;
+  int nStim = 0;                           // node at the centre of the stimulus
+  int *rowList;                            // store rows indexed by n
+  int *colList;                            // store cols indexed by n
+  
+  const double threshold = -70.0;          // threshold for APD90 detection
+  double lastS1;
+  double **upStrokeTime;                   // array to store upstroke times for final S1 beat
+  double **downStrokeTime;                 // array to store upstroke times for S2 beat
+  double *timing;
+  int *beat;
+
+  FILE *egPtr;
+  char outputFile[CONFIG_STRLEN + 32];					          // filename for outputs
+
+  /* runtime settings, from the header, a config file and the command line */
+  default_config_2D( &config );
+  if (parse_config_args_2D( &config, argc, argv ) > 0)
+    nrerror("bad command line options");
+
+  /* with an ensemble, the lookup table is built once and shared by */
+  /* the samples, which each carry on from here in a child process */
+  if (config.ensemble[0])
+    {
+    lookup = create_lookup_2D( config.dt, config.parameterSet );
+    lookupMade = 1;
+    i = run_ensemble_2D( &config, lookup );
+    if (i < 0)
+      exit(-1 - i);
+    printf("ensemble sample %d\n", i);
+    }
+
+  tmax = config.numIterations;
+  nrows = config.nrows;
+  ncols = config.ncols;
+  RC = (long) nrows * ncols;
+  dtlong = config.dt;
+  half_dtlong = config.dt/2.0;
+  bcl = config.bcl;
+  numS1Beats = config.numS1Beats;
+  numS2Beats = config.numS2Beats;
+  lastS1 = bcl * (numS1Beats - 1.0);
+  radius = config.stimRadius;
+  radius2 = radius*radius;
+  numThreads = config.threads;
+  kernel = config.kernel;
+  gateTol = config.gate;
+  snapshots = config.snapshots;
+  if (config.chkptInterval > 0.0)
+    chkptSteps = (int) (config.chkptInterval / dtlong + 0.5);
+
+  restart = config.restart;
+  if (restart == CHKPT_LATEST)
+    {
+    restart = checkpoint_latest();
+    if (restart < 0)
+      nrerror("no checkpoint to restart from");
+    }
+
+  /* keep a record of the settings with the output */
+  sprintf(outputFile,"%sconfig.txt",config.outputRoot);
+  cfgPtr = fopen(outputFile,"w");
+  if (cfgPtr)
+    {
+    write_config_2D( &config, cfgPtr );
+    fclose(cfgPtr);
+    }
+
+#ifdef _OPENMP
+  if (numThreads > 0)
+    omp_set_num_threads(numThreads);
+  printf("reaction step using up to %d threads\n", omp_get_max_threads());
+#else
+  if (numThreads > 0)
+    printf("compiled without OpenMP, ignoring -threads %d\n", numThreads);
+#endif
+
+  /* Create lookup table, unless it was made for an ensemble */
+  if (!lookupMade)
+    {
+    printf("create lookup table ...\n");
+    lookup = create_lookup_2D( dtlong, config.parameterSet );
+    printf("done\n");
+    }
+
+  /* pace a single cell to steady state, write it to seedOut and stop, */
+  /* which needs no geometry or diffusion file */
+  if (config.makeSeed > 0)
+    {
+    printf("pacing a single cell for %d beats at %g ms ...\n", config.makeSeed, bcl);
+    U = fvector(1, num_states);
+    if (config.seedFile[0])
+      dummy = checkpoint_seed_read( config.seedFile, config.seedNode, U );
+    else
+      {
+      u = create_state_2D( 1 );
+      initialise_variables_2D( u, 1 );
+      for (m = 1; m <= num_states; m++)
+        U[m] = u->var[m][1];
+      free_state_2D( u );
+      }
+    pace_cell_2D( U, lookup, bcl, config.makeSeed );
+    dummy = checkpoint_seed_write( config.seedOut, U, config.makeSeed * bcl );
+    free_fvector(U, 1, num_states);
+    exit(0);
+    }
+
+  /* Create geometry and nearest neighbour arrays */
+  geom = imatrix( 1, nrows, 1, ncols );
+  nneighb = imatrix( 1, RC, 1, 4 );
+  printf("initialising geometry arrays\n");
+  D = fvector(1, RC);
+  N = initialise_geometry_2D( geom, nrows, ncols, nneighb, D, config.scar );
+  stencil = create_stencil_2D( geom, nrows, ncols, nneighb, D, N, config.scar );
+  free_imatrix(nneighb, 1, RC, 1, 4);
+  numProbes = probe_nodes_2D( geom, nrows, ncols, probeNode );
+  cells = create_cellmap_2D( geom, nrows, ncols, N );
+
+  /* Initialise arrays */
+  u = create_state_2D( N );
+  dVdt = fvector( 1, N );
+  new_Vm = fvector( 1, N );
+  old_Vm = fvector( 1, N );
+  params = fvector(1, num_params);
+  celltype = ivector(1, N);
+
+  /* arrays for apd90 detection */
+  upStrokeTime = fmatrix(1, N, 1, numS1Beats + numS2Beats);
+  downStrokeTime = fmatrix(1, N, 1, numS1Beats + numS2Beats);
+  beat = ivector(1, N);
+  timing = fvector(1,N);
+
+  /* Initialise model state and paramaters */
+  printf("initialising ...\n");
+  initialise_variables_2D( u, N );
+  printf("done\n");
+
+  /* start every node from the state of one node of an earlier run, */
+  /* which can have a different geometry */
+  if (config.seedFile[0])
+    {
+    U = fvector(1, num_states);
+    dummy = checkpoint_seed_read( config.seedFile, config.seedNode, U );
+    seed_variables_2D( u, N, U );
+    free_fvector(U, 1, num_states);
+    }
+
+  /* set celltype to be 1 throughout */
+  m = 0;
+  for (n = 1; n <= N; n++)
+      celltype[n] = 1;
+
+  /* only excitable nodes need the reaction step and upstroke detection */
+  excitable = ivector(1, N);
+  passive = ivector(1, N);
+  numExcitable = 0;
+  numPassive = 0;
+  for (n = 1; n <= N; n++)
+    {
+    if ((celltype[n] == 1) && (D[n] >= 0.025))
+      excitable[++numExcitable] = n;
+    else
+      passive[++numPassive] = n;
+    }
+  printf("%d excitable and %d passive nodes\n", numExcitable, numPassive);
+
+  /* the excitable nodes of each class are taken together, in blocks */
+  /* of up to SIMD_BLOCK nodes of a single class for the SIMD kernel */
+  blockStart = ivector(0, numExcitable / SIMD_BLOCK + cells->numClasses + 1);
+  numBlocks = group_nodes_2D( cells, excitable, numExcitable, blockStart, SIMD_BLOCK );
+
+  /* nodes at rest can be held until they are disturbed */
+  frozen = ivector(1, N);
+  dVreac = fvector(1, N);
+  for (n = 1; n <= N; n++)
+    {
+    frozen[n] = 0;
+    dVreac[n] = 0.0;
+    }
+  if (gateTol > 0.0)
+    printf("holding nodes at rest, tolerance %g\n", gateTol);
+
+  /* initialise indexing of rows and columns */
+  rowList = ivector(1,N);
+  colList = ivector(1,N);
+  if ((config.stimRow < 1) || (config.stimRow > nrows) || (config.stimCol < 1) || (config.stimCol > ncols))
+    nrerror("stimulus is outside the grid");
+  nStim = geom[config.stimRow][config.stimCol];
+  if (nStim <= 0)
+    nrerror("centre of the stimulus is not a node (it is in a hole in the tissue)");
+
+  for (row = 1; row <= nrows; row++)
+    {
+      for (col = 1; col <= ncols; col++)
+        {
+          n = geom[row][col];
+          if (n >= 1)
+            {
+              rowList[n] = row;
+              colList[n] = col;
+            }
+        }
+    }
+
+  /* initialise upstroke and downstroke arrays */
+  for (n = 1; n <= N; n++)
+    {
+      beat[n] = 1;
+      for (m = 1; m <= numS1Beats + numS2Beats; m++)
+        {
+          upStrokeTime[n][m] = -1.0;
+          downStrokeTime[n][m] = -1.0;
+        }
+    }
+
+  /* check the SIMD kernel against the scalar kernel before using it */
+  if (kernel == KERNEL_SIMD)
+    {
+    if (validate_TP06_block_kernel( lookup, 1.0e-6 ))
+      printf("using SIMD kernel, %d nodes per block\n", SIMD_BLOCK);
+    else
+      {
+      printf("SIMD kernel does not agree with scalar kernel, using scalar kernel\n");
+      kernel = KERNEL_SCALAR;
+      }
+    }
+
+  /* last bit of initialisation */
+  t = 0;
+  time = 0.0;
+
+  /* everything needed to carry on from a checkpoint */
+  chk.N = N;
+  chk.nrows = nrows;
+  chk.ncols = ncols;
+  chk.numBeats = numS1Beats + numS2Beats;
+  chk.scar = config.scar;
+  if (config.grf > 0.0)
+    chk.dHash = hash_data_2D( &D[1], N * sizeof(double) );
+  else
+    chk.dHash = hash_file_2D( config.diffusionFile );
+  chk.u = u;
+  chk.new_Vm = new_Vm;
+  chk.old_Vm = old_Vm;
+  chk.dVdt = dVdt;
+  chk.dVreac = dVreac;
+  chk.egOffset = chk.snapOffset = -1;
+  chk.upStrokeTime = upStrokeTime;
+  chk.downStrokeTime = downStrokeTime;
+  chk.beat = beat;
+  chk.frozen = frozen;
+
+  if (config.chkptRead || (restart >= 0))
+    {
+  	dummy = checkpoint_read( &chk, (restart >= 0) ? restart : config.chkptReadTime );
+  	t = chk.t;
+  	time = chk.time;
+  	stfcount = chk.stfcount;
+  	nextStim = chk.nextStim;
+    }
+
+  /* open files for output, after a restart carrying on from where */
+  /* the run that wrote the checkpoint had got to */
+  sprintf(outputFile,"%sVm_2.txt",config.outputRoot);
+  if (restart >= 0)
+    {
+    egPtr = checkpoint_append( outputFile, chk.egOffset );
+    if (snapshots != SNAPSHOT_STF)
+      snap = reopen_snapshots_2D( config.snapshotFile, ncols, nrows, snapshots, chk.snapOffset );
+    }
+  else
+    {
+    egPtr = fopen(outputFile,"w");
+    if (snapshots != SNAPSHOT_STF)
+      snap = open_snapshots_2D( config.snapshotFile, ncols, nrows, snapshots );
+    }
+  if (!egPtr) nrerror("cannot open electrogram file");
+  writer = create_writer_2D( N, geom, nrows, ncols, egPtr, snap, snapshots, config.keep );
+
+  /* the checkpoint a run restarted from, and those before it at the */
+  /* same interval, count towards the checkpoints kept */
+  if ((restart >= 0) && (chkptSteps > 0))
+    {
+    for (i = config.keep - 1; i >= 1; i--)
+      if (restart - i * chkptSteps > 0)
+        keep_checkpoint_2D( writer, restart - i * chkptSteps );
+    keep_checkpoint_2D( writer, restart );
+    }
+
+/******************************************/
+/*               Main loop                */
+/******************************************/
+  printf("entering main loop\n");
+
+  while (t < tmax)
+	  {
+      time = t * dtlong;
+      t++;
+
+/* step 1 */
+/* only at start */
+      if (t == 1)
+         {
+         diffusion_2D( stencil, u->Vm, new_Vm, half_dtlong );
+         for (n = 1; n <= N; n++)
+            dVdt[n] = new_Vm[n] - u->Vm[n];
+         }
+
+/* step 2 */
+/* pacing protocol -- deliver stimulus to one corner */
+/* decided once per time step so that the loop over nodes is independent */
+      S1stimFlag = 0;
+      S2stimFlag = 0;
+
+      // S1 pacing, 2 ms at the start of each of numS1Beats cycles
+      for (i = 0; i < numS1Beats; i++)
+        if ((i == 0) ? (time <= 2.0) : ((time > i*bcl) && (time <= i*bcl + 2.0)))
+          S1stimFlag = 1;
+      if (S1stimFlag == 1)
+        {
+          printf("Preparing to deliver S1 stimulus at time %f, u[%d][1] = %f\n",time,nStim,u->Vm[nStim]);
+        }
+
+      if ((time > config.s2Start) && (u->Vm[nStim] <= -84.5) && (time < config.s2End))
+        {
+          printf("Preparing to deliver S2 stimulus at time %f, u[%d][1] = %f\n",time,nStim,u->Vm[nStim]);
+          nextStim = time;
+        }
+
+      if ((nextStim > 0) && (time < nextStim + 2.0) && (time >= nextStim))
+        {
+          printf("Delivering S2 -- time = %f, nextStim = %f\n",time,nextStim);
+          S2stimFlag = 1;
+        }
+
+      if ((nextStim > 0) && (time >= nextStim + 2.0))
+        {
+          nextStim = 0;
+        }
+
+      if (S1stimFlag == 1)
+        printf("Delivering S1 -- time = %f\n",time);
+
+/* passive nodes only take the new Vm from the diffusion step */
+#pragma omp parallel for
+      for (j = 1; j <= numPassive; j++)
+        u->Vm[passive[j]] = new_Vm[passive[j]];
+
+/* set up integration with adaptive timestep */
+/* with the SIMD kernel, blocks of up to SIMD_BLOCK excitable nodes of a single */
+/* class are advanced together; each lane takes its own kmax sub-steps and is */
+/* masked off when done */
+      if (kernel == KERNEL_SIMD)
+        {
+#pragma omp parallel for schedule(dynamic, OMP_CHUNK/SIMD_BLOCK) private(n, m, k, l, j0, nb, kblock, ko, kmax, row, col, contiguous, quiet, err, Ub, Ulane, Uold, laneDt, laneStim, laneK, laneActive, laneIion) reduction(+:numSkipped, numSolved) reduction(max:gateErr)
+        for (b = 0; b < numBlocks; b++)
+          {
+          j0 = blockStart[b];
+          nb = blockStart[b + 1] - j0;
+          kblock = 0;
+
+          for (l = 0; l < nb; l++)
+            {
+            n = excitable[j0 + l];
+
+            col = colList[n] - config.stimCol;
+            row = rowList[n] - config.stimRow;
+            if (((S1stimFlag == 1) || (S2stimFlag == 1)) && (row*row + col*col <= radius2))
+              laneStim[l] = -52.0;
+            else
+              laneStim[l] = 0.0;
+
+            u->Vm[n] = new_Vm[n];
+
+            if ((frozen[n] > 0) && (frozen[n] < GATE_REFRESH) && (fabs(dVdt[n]) < gateTol) && (laneStim[l] == 0.0))
+              {
+              u->Vm[n] += dVreac[n];
+              frozen[n]++;
+              numSkipped++;
+              laneK[l] = 0;
+              laneDt[l] = dtlong;
+              continue;
+              }
+            numSolved++;
+
+            if (dVdt[n] > 0.01) ko = 5; else ko = 1;
+            kmax = ko + floor(fabs(dVdt[n]) * 20.0);
+            if (kmax > ceil(dtlong/0.01))
+              kmax = dtlong/0.01;
+
+            laneK[l] = kmax;
+            laneDt[l] = dtlong / (double) kmax;
+            if (kmax > kblock) kblock = kmax;
+            }
+
+          /* every node in the block is held at rest */
+          if (kblock == 0)
+            continue;
+
+          /* work on u directly unless the block spans a gap in the tissue */
+          contiguous = (excitable[j0 + nb - 1] - excitable[j0] == nb - 1);
+          for (m = 1; m <= num_states; m++)
+            {
+            if (contiguous)
+              Ub[m] = &u->var[m][excitable[j0]];
+            else
+              {
+              for (l = 0; l < nb; l++)
+                Ulane[m][l] = u->var[m][excitable[j0 + l]];
+              Ub[m] = Ulane[m];
+              }
+            }
+
+          if (gateTol > 0.0)
+            for (m = 1; m <= num_states; m++)
+              for (l = 0; l < nb; l++)
+                Uold[m][l] = Ub[m][l];
+
+          /* integrate ODEs using Rush and Larsen scheme */
+          for (k = 1; k <= kblock; k++)
+            {
+            for (l = 0; l < nb; l++)
+              laneActive[l] = (k <= laneK[l]);
+
+            calculate_TP06_current_OpSplit_block( Ub, nb, laneDt, laneActive, lookup, cells, cells->cls[excitable[j0]],
+                                                  laneStim, laneIion );
+
+            for (l = 0; l < nb; l++)
+              if (laneActive[l])
+                Ub[V][l] = Ub[V][l] - laneDt[l] * laneIion[l];
+            }
+
+          if (gateTol > 0.0)
+            for (l = 0; l < nb; l++)
+              if (laneK[l] > 0)
+                {
+                quiet = 1;
+                for (m = 1; m <= num_states; m++)
+                  if ((m != V) && (fabs(Ub[m][l] - Uold[m][l]) > gateTol * fabs(Uold[m][l])))
+                    quiet = 0;
+                n = excitable[j0 + l];
+                err = gate_node( &frozen[n], &dVreac[n], Ub[V][l] - Uold[V][l], quiet, dVdt[n], gateTol );
+                if (err > gateErr) gateErr = err;
+                }
+
+          if (!contiguous)
+            for (m = 1; m <= num_states; m++)
+              for (l = 0; l < nb; l++)
+                u->var[m][excitable[j0 + l]] = Ulane[m][l];
+          }
+        }
+      else
+/* each thread works on its own copy of U, and nodes are handed out */
+/* dynamically because kmax (and so the cost) varies across the wavefront */
+#pragma omp parallel private(n, m, k, ko, kmax, row, col, dtshort, dV, stimCurrent, quiet, err, U) reduction(+:numSkipped, numSolved) reduction(max:gateErr)
+      {
+      U = fvector(1, num_states);
+
+#pragma omp for schedule(dynamic, OMP_CHUNK)
+      for (j = 1; j <= numExcitable; j++)
+        {
+          n = excitable[j];
+          stimCurrent = 0.0;
+
+          col = colList[n];
+          col -= config.stimCol;
+          row = rowList[n];
+          row -= config.stimRow;
+
+          if (((S1stimFlag == 1) || (S2stimFlag == 1)) && (row*row + col*col <= radius2))
+            {
+              stimCurrent = -52.0;
+            }
+
+          /* Operator splitting with adaptive time step for ODE */
+      	  u->Vm[n] = new_Vm[n];
+
+          /* with -gate, a node at rest is held until diffusion or a stimulus disturbs it, */
+          /* its gates and concentrations are frozen and Vm keeps the last reaction rate */
+          if ((frozen[n] > 0) && (frozen[n] < GATE_REFRESH) && (fabs(dVdt[n]) < gateTol) && (stimCurrent == 0.0))
+            {
+            u->Vm[n] += dVreac[n];
+            frozen[n]++;
+            numSkipped++;
+            continue;
+            }
+          numSolved++;
+
+          // uncomment these lines to implement adaptive time step
+          // this implementation provides good agreement with standard scheme for dt=0.01 ms
+          // apart from delay of ~0.1 ms in onset of AP upstroke
+   	      if (dVdt[n] > 0.01) ko = 5; else ko = 1;
+              kmax = ko + floor(fabs(dVdt[n]) * 20.0); // kmax varies between ko and 10
+          if (kmax > ceil(dtlong/0.01))
+              kmax = dtlong/0.01;
+
+		      // comment this line to implement adaptive time step
+		      // kmax = 1;
+
+		      dtshort = dtlong / (double) kmax;
+
+		      /* store state of current point in U temporarily*/
+		      for (m = 1; m <= num_states; m++)
+            U[m] = u->var[m][n];
+
+          /* integrate ODEs using Rush and Larsen scheme */
+		      for (k = 1; k <= kmax; k++)
+	    	    {
+            dV = dtshort * calculate_TP06_current_OpSplit( U, dtshort, lookup, cells, cells->cls[n], stimCurrent );
+
+
+ 	    	    U[V] = U[V] - dV;
+	    	    }
+
+          if (gateTol > 0.0)
+            {
+            quiet = 1;
+            for (m = 1; m <= num_states; m++)
+              if ((m != V) && (fabs(U[m] - u->var[m][n]) > gateTol * fabs(u->var[m][n])))
+                quiet = 0;
+            err = gate_node( &frozen[n], &dVreac[n], U[V] - u->Vm[n], quiet, dVdt[n], gateTol );
+            if (err > gateErr) gateErr = err;
+            }
+
+		      /* update state u with new values stored in U */
+		      for (m = 1; m <= num_states; m++)
+	   	 	    u->var[m][n] = U[m];
+
+        }
+
+      free_fvector(U, 1, num_states);
+      }
+/* end of step 2 */
+
+/* step 3 */
+
+      /* calculate diffusion, two half steps */
+      /* also sets old_Vm and dVdt, and leaves the first half step in u->Vm */
+      diffusion_2D_step( stencil, u->Vm, new_Vm, old_Vm, dVdt, half_dtlong );
+
+/* end of step  3*/
+
+/* detect upstrokes and downstrokes */
+
+      if (time >= lastS1)
+        {
+        for (j = 1; j <= numExcitable; j++)
+          {
+          n = excitable[j];
+          if ((new_Vm[n] > threshold) && (old_Vm[n] <= threshold) && (upStrokeTime[n][beat[n]] < 0))
+            {
+            upStrokeTime[n][beat[n]] = time;
+            }
+
+    // only detect downstroke if upstroke has been detected first
+          if ((new_Vm[n] < threshold) && (old_Vm[n] >= threshold) && (upStrokeTime[n][beat[n]] > 0))
+            {
+            downStrokeTime[n][beat[n]] = time;
+
+            if (beat[n] < numS1Beats)
+              {
+              beat[n]++;
+              }
+            }
+          }
+        }
+
+/* output electrogram data every egInterval ms (1 ms) */
+	  if (modf(time/config.egInterval, &timems) == 0.0)
+		  {
+/* and write electrograms to eg file, and to the screen, in the background */
+      for (i = 0; i < numProbes; i++)
+        egValues[i] = (probeNode[i] > 0) ? new_Vm[probeNode[i]] : 0.0;
+      queue_electrogram_2D( writer, timems * config.egInterval, egValues, numProbes );
+      }
+
+/* output stf file every snapInterval ms (10 ms) */
+    if (modf(time/config.snapInterval, &timems) < 0.0001)
+      {
+      queue_snapshot_2D( writer, u->Vm, (int) (stfcount*config.snapInterval + 0.5), time );
+      stfcount++;
+      }
+
+/* write to checkpoint file if needed */
+      if (config.chkptWrite)
+        {
+    	  if (t == config.chkptWriteTime)
+    	    {
+    	    chk.t = t;
+    	    chk.time = time;
+    	    chk.stfcount = stfcount;
+    	    chk.nextStim = nextStim;
+    	    writer_offsets_2D( writer, &chk );
+    		dummy = checkpoint_write( &chk, config.chkptWriteTime );
+    	    }
+        }
+
+/* periodic checkpoint, written in the background */
+      if ((chkptSteps > 0) && (t % chkptSteps == 0))
+        {
+        chk.t = t;
+        chk.time = time;
+        chk.stfcount = stfcount;
+        chk.nextStim = nextStim;
+        queue_checkpoint_2D( writer, &chk, t );
+        }
+
+  }
+  printf("leaving main loop\n");
+  free_writer_2D(writer);
+
+  if (gateTol > 0.0)
+    printf("activity gating: %ld of %ld reaction steps skipped, error in Vm at most %g mV\n",
+      numSkipped, numSkipped + numSolved, gateErr);
+
+  /* save upstroke and downstroke data to files, for up to 4 beats */
+  for (m = 1; (m <= 4) && (m <= numS1Beats + numS2Beats); m++)
+    {
+    for (n = 1; n <= N; n++)
+      timing[n] = upStrokeTime[n][m];
+    sprintf( outputFile,"%supStrokeTimeS%d.stf",config.outputRoot,m);
+    writeData(outputFile, timing, geom, nrows, ncols);
+
+    for (n = 1; n <= N; n++)
+      timing[n] = downStrokeTime[n][m];
+    sprintf( outputFile,"%sdownStrokeTimeS%d.stf",config.outputRoot,m);
+    writeData(outputFile, timing, geom, nrows, ncols);
+    }
+
+  sprintf( outputFile,"%sdiffusion.stf",config.outputRoot);
+  writeData(outputFile, D, geom, nrows, ncols);
+
+  fclose(egPtr);
+  if (snap)
+    close_snapshots_2D(snap);
+
+  /* end of main loop */
+
+  /* Free memory */
+  free_lookup_2D(lookup);
+  free_state_2D(u);
+  free_imatrix(geom, 1, nrows, 1, ncols);
+  free_stencil_2D(stencil);
+  free_fvector(dVdt, 1, N );
+  free_fvector(new_Vm, 1, N );
+  free_fvector(old_Vm, 1, N );
+  free_fvector(params, 1, num_params);
+  free_ivector(celltype, 1, N);
+  free_ivector(excitable, 1, N);
+  free_ivector(blockStart, 0, numExcitable / SIMD_BLOCK + cells->numClasses + 1);
+  free_cellmap_2D(cells);
+  free_ivector(passive, 1, N);
+  free_ivector(frozen, 1, N);
+  free_fvector(dVreac, 1, N);
+
+  free_fmatrix(upStrokeTime, 1, N, 1, numS1Beats + numS2Beats);
+  free_fmatrix(downStrokeTime, 1, N, 1, numS1Beats + numS2Beats);
+  free_ivector(beat, 1, N);
+  free_ivector(rowList, 1, N);
+  free_ivector(colList, 1, N);
+
+}
+
+void writeData(char *fname, double *dataToWrite, int **geomarray, int nrows, int ncols)
+{
+    int lay, row, col;
+    int index, outint;
+    double outdouble;
+    FILE *stf_file;
+
+    stf_file = fopen( fname, "w" );
+
+    fprintf(stf_file, "NAME Vm\n");
+    fprintf(stf_file, "RANK 2\n");
+    fprintf(stf_file, "DIMENSIONS %d %d\n",ncols, nrows);
+    fprintf(stf_file, "BOUNDS %d %d %d %d\n", 0, ncols-1, 0, nrows-1);
+    fprintf(stf_file, "SCALAR\n");
+    fprintf(stf_file, "DATA\n");
+
+    for (row = 1;row <= nrows; row+=1)
+        {
+        for (col = 1; col <= ncols; col+=1)
+            {
+            index = (geomarray[row][col] > 0)?geomarray[row][col]:0;
+            if (index > 0)
+                outdouble = dataToWrite[index];
+            else
+                outdouble = 0.0;
+            fprintf(stf_file, "%6.4f ", outdouble);
+            }
+        fprintf( stf_file, "\n");
+        }
+    fclose(stf_file);
+}
+
+/***************************************************************
+
+ gate_node
+
+ called after a node has been solved in full with -gate. dVreac
+ is the change in Vm from the reaction step, and quiet is set if
+ no other state variable changed by more than tol relative to its
+ value. The node is held at rest from the next step if it is
+ quiet and the change in Vm over the last time step was below
+ tol.
+
+ While a node is held Vm changes by the reaction step measured
+ when it was frozen, so the error in Vm comes from the change in
+ this rate. Returns the largest error in Vm from the steps
+ skipped since the node was frozen, assuming the rate changed
+ steadily between the two full solves either side of them.
+
+***************************************************************/
+
+double gate_node(int *frozen, double *rate, double dVreac, int quiet, double dVdt, double tol)
+{
+  double err = 0.0;
+
+  if (*frozen > 1)
+    err = (*frozen - 1) * fabs(dVreac - *rate);
+
+  *rate = dVreac;
+  *frozen = (quiet && (fabs(dVdt) < tol)) ? 1 : 0;
+
+  return err;
+}
@@ -0,0 +1,472 @@
+/***************************************************************
+
+ batch_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+#include <errno.h>
+#include <sys/stat.h>
+
+/***************************************************************
+
+ Advances S samples (S <= SIMD_BLOCK) of the same grid together.
+ The samples differ only in their diffusion coefficients, so
+ every grid point is a node in all of them, numbered
+ (row-1)*ncols + col, and the state of sample l at node n is held
+ at index (n-1)*S + 1 + l. The lanes of a node, and the nodes of
+ a row, are next to each other in every state array, so the
+ block kernel works on SIMD_BLOCK lanes at a time in place, and
+ the stencil sweep runs along whole rows of lanes
+ (create_batch_stencil_2D()). A lane that is scar in its sample
+ is held out of the reaction step and has no diffusion weights,
+ so the lanes are full whatever the layout of the scar.
+
+ Each sample is solved as it would be with -kernel simd on its
+ own: the pacing protocol, time step and adaptive kmax are taken
+ lane by lane, and the output is written to the directory of its
+ diffusion file with the same names. Gating and checkpoints are
+ not available. With cell parameter maps, a block that spans nodes
+ of more than one class is solved lane by lane with the scalar
+ kernel, so those lanes agree with a run on its own to rounding.
+
+***************************************************************/
+
+int run_batch_2D( config_2D *c, lookup_2D *lookup, char **list, int S )
+{
+  const int num_states = NUM_STATES;
+  const int V = 1;
+  const double threshold = -70.0;          // threshold for APD90 detection
+  const int nrows = c->nrows, ncols = c->ncols;
+  const long RC = (long) nrows * ncols;
+  const long NS = RC * S;                  // lanes in the batch
+  const double dtlong = c->dt;
+  const double half_dtlong = c->dt / 2.0;
+  const double bcl = c->bcl;
+  const int numS1Beats = c->numS1Beats;
+  const int numBeats = c->numS1Beats + c->numS2Beats;
+  const double lastS1 = bcl * (numS1Beats - 1.0);
+  const int radius2 = c->stimRadius * c->stimRadius;
+
+  int t, tmax, n, m, i, l, k, ko, kmax, kblock, row, col;
+  int b, j0, nb, numBlocks;
+  int kernel = KERNEL_SIMD;
+  int snapshots;
+  int ***geom, **nneighb, **geomOut, *numNodes;
+  double **D, *Dout;
+  stencil_2D **sample, *stencil;
+  state_2D *u;
+  double *dVdt, *new_Vm, *old_Vm, *Vs;
+  double U[NUM_STATES + 1];                // state of one node for the scalar kernel
+  int *excitable, *inStim, nStim;
+  cellmap_2D *cells;                       // cell parameters of each node, the same in every sample
+  int **gridNode, cls;
+  int egIndex[SIMD_BLOCK][MAX_PROBES];     // lane of each electrogram probe, 0 if not a node
+  int probeNode[MAX_PROBES], numProbes;
+  double **upStrokeTime, **downStrokeTime;
+  int *beat;
+  double *Ub[NUM_STATES + 1];
+  double laneDt[SIMD_BLOCK], laneStim[SIMD_BLOCK], laneIion[SIMD_BLOCK];
+  int laneK[SIMD_BLOCK], laneActive[SIMD_BLOCK];
+  double time = 0.0, timems = 0.0, dV;
+  double nextStim[SIMD_BLOCK];
+  int S1stimFlag, S2stimFlag[SIMD_BLOCK];
+  int stfcount = 0;
+  char *prefix[SIMD_BLOCK], *p;
+  char fname[2 * CONFIG_STRLEN + 32];
+  FILE *egPtr[SIMD_BLOCK], *cfgPtr;
+  snapshot_file *snap[SIMD_BLOCK];
+  writer_2D *writer[SIMD_BLOCK];
+  double egValues[MAX_PROBES];
+  config_2D cs;
+
+  if ((S < 1) || (S > SIMD_BLOCK))
+    nrerror("batch size must be between 1 and SIMD_BLOCK");
+  if ((long) (nrows + 2) * (ncols + 2) * S > INT_MAX)
+    nrerror("grid is too large for a batch of this size");
+  if ((c->gate > 0.0) || c->chkptRead || c->chkptWrite || (c->chkptInterval > 0.0) || (c->restart >= 0))
+    nrerror("gating and checkpoints are not available in batch mode");
+
+  tmax = c->numIterations;
+  snapshots = c->snapshots;
+  if (snapshots == SNAPSHOT_STF)
+    {
+    printf("stf snapshots are not available in batch mode, writing 16 bit snapshots\n");
+    snapshots = SNAPSHOT_INT16;
+    }
+
+#ifdef _OPENMP
+  if (c->threads > 0)
+    omp_set_num_threads(c->threads);
+  printf("batch of %d samples using up to %d threads\n", S, omp_get_max_threads());
+#endif
+
+  /* geometry of each sample, and the batch stencil built from theirs */
+  /* (initialise_geometry_2D() reads config.diffusionFile) */
+  geom = (int ***) malloc(S * sizeof(int **));
+  D = (double **) malloc(S * sizeof(double *));
+  sample = (stencil_2D **) malloc(S * sizeof(stencil_2D *));
+  numNodes = ivector(0, S-1);
+  nneighb = imatrix( 1, RC, 1, 4 );
+  for (l = 0; l < S; l++)
+    {
+    printf("sample %d: %s\n", l, list[l]);
+    prefix[l] = (char *) malloc(strlen(list[l]) + 2);
+    strcpy(prefix[l], list[l]);
+    p = strrchr(prefix[l], '/');
+    if (p) p[1] = '\0'; else prefix[l][0] = '\0';
+
+    strcpy(config.diffusionFile, list[l]);
+    geom[l] = imatrix( 1, nrows, 1, ncols );
+    D[l] = fvector( 1, RC );
+    numNodes[l] = initialise_geometry_2D( geom[l], nrows, ncols, nneighb, D[l], c->scar );
+    sample[l] = create_stencil_2D( geom[l], nrows, ncols, nneighb, D[l], numNodes[l], c->scar );
+    }
+  stencil = create_batch_stencil_2D( sample, S );
+  for (l = 0; l < S; l++)
+    free_stencil_2D(sample[l]);
+  free_imatrix(nneighb, 1, RC, 1, 4);
+
+  /* state, with every lane initialised as a node of a single run */
+  u = create_state_2D( NS );
+  initialise_variables_2D( u, NS );
+  if (c->seedFile[0])
+    {
+    checkpoint_seed_read( c->seedFile, c->seedNode, U );
+    seed_variables_2D( u, NS, U );
+    }
+  numBlocks = (NS + SIMD_BLOCK - 1) / SIMD_BLOCK;
+  dVdt = avector( 1, NS );
+  new_Vm = avector( 1, NS );
+  old_Vm = avector( 1, NS );
+
+  /* lanes that take the reaction step, as the excitable nodes in main() */
+  excitable = ivector(1, NS);
+  inStim = ivector(1, RC);
+  for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+    {
+    n = (row - 1) * ncols + col;
+    inStim[n] = ((row - c->stimRow)*(row - c->stimRow) + (col - c->stimCol)*(col - c->stimCol) <= radius2);
+    for (l = 0; l < S; l++)
+      {
+      m = geom[l][row][col];
+      excitable[(n-1)*S + 1 + l] = (m > 0) && (D[l][m] >= 0.025);
+      }
+    }
+
+  /* electrograms are taken at the probes, where they are nodes */
+  for (l = 0; l < S; l++)
+    {
+    numProbes = probe_nodes_2D( geom[l], nrows, ncols, probeNode );
+    for (k = 0; k < numProbes; k++)
+      egIndex[l][k] = (probeNode[k] > 0) ? ((c->probeRow[k] - 1) * ncols + c->probeCol[k] - 1)*S + 1 + l : 0;
+    }
+  if ((c->stimRow < 1) || (c->stimRow > nrows) || (c->stimCol < 1) || (c->stimCol > ncols))
+    nrerror("stimulus is outside the grid");
+  nStim = (c->stimRow - 1) * ncols + c->stimCol;
+  for (l = 0; l < S; l++)
+    if (geom[l][c->stimRow][c->stimCol] <= 0)
+      {
+      printf("sample %d: %s\n", l, list[l]);
+      nrerror("centre of the stimulus is not a node (it is in a hole in the tissue)");
+      }
+
+  /* cell parameters, for every grid point as a node */
+  gridNode = imatrix( 1, nrows, 1, ncols );
+  for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+    gridNode[row][col] = (row - 1) * ncols + col;
+  cells = create_cellmap_2D( gridNode, nrows, ncols, RC );
+  free_imatrix(gridNode, 1, nrows, 1, ncols);
+
+  upStrokeTime = fmatrix(1, NS, 1, numBeats);
+  downStrokeTime = fmatrix(1, NS, 1, numBeats);
+  beat = ivector(1, NS);
+  for (i = 1; i <= NS; i++)
+    {
+    beat[i] = 1;
+    for (m = 1; m <= numBeats; m++)
+      upStrokeTime[i][m] = downStrokeTime[i][m] = -1.0;
+    }
+
+  /* output for each sample goes to the directory of its diffusion file */
+  /* geomOut is the numbering of the batch, less the grid points that */
+  /* are not nodes in the sample */
+  Vs = fvector(1, RC);
+  for (l = 0; l < S; l++)
+    {
+    cs = *c;
+    strcpy(cs.diffusionFile, list[l] + strlen(prefix[l]));
+    cs.ensemble[0] = '\0';
+    cs.batch = 1;
+    cs.kernel = KERNEL_SIMD;
+    sprintf(fname, "%s%sconfig.txt", prefix[l], c->outputRoot);
+    cfgPtr = fopen(fname, "w");
+    if (cfgPtr)
+      {
+      write_config_2D( &cs, cfgPtr );
+      fclose(cfgPtr);
+      }
+
+    sprintf(fname, "%sSTFfiles", prefix[l]);
+    if ((mkdir(fname, 0755) != 0) && (errno != EEXIST))
+      perror(fname);
+    sprintf(fname, "%s%sVm_2.txt", prefix[l], c->outputRoot);
+    egPtr[l] = fopen(fname, "w");
+    if (!egPtr[l]) nrerror("cannot open electrogram file");
+    sprintf(fname, "%s%s", prefix[l], c->snapshotFile);
+    snap[l] = open_snapshots_2D( fname, ncols, nrows, snapshots );
+
+    geomOut = imatrix( 1, nrows, 1, ncols );
+    for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+      geomOut[row][col] = (geom[l][row][col] > 0) ? (row - 1) * ncols + col : -1;
+    writer[l] = create_writer_2D( RC, geomOut, nrows, ncols, egPtr[l], snap[l], snapshots, 1 );
+    nextStim[l] = 0.0;
+    }
+
+  if (!validate_TP06_block_kernel( lookup, 1.0e-6 ))
+    {
+    printf("SIMD kernel does not agree with scalar kernel, using scalar kernel\n");
+    kernel = KERNEL_SCALAR;
+    }
+
+/******************************************/
+/*               Main loop                */
+/******************************************/
+  printf("entering main loop\n");
+
+  t = 0;
+  while (t < tmax)
+    {
+    time = t * dtlong;
+    t++;
+
+    if (t == 1)
+      {
+      diffusion_2D( stencil, u->Vm, new_Vm, half_dtlong );
+      for (i = 1; i <= NS; i++)
+        dVdt[i] = new_Vm[i] - u->Vm[i];
+      }
+
+    /* pacing protocol, S1 is the same for every sample and S2 depends */
+    /* on Vm at the stimulus in each */
+    S1stimFlag = 0;
+    for (i = 0; i < numS1Beats; i++)
+      if ((i == 0) ? (time <= 2.0) : ((time > i*bcl) && (time <= i*bcl + 2.0)))
+        S1stimFlag = 1;
+    if (S1stimFlag == 1)
+      printf("Delivering S1 -- time = %f\n",time);
+
+    for (l = 0; l < S; l++)
+      {
+      i = (nStim - 1)*S + 1 + l;
+      S2stimFlag[l] = 0;
+      if ((time > c->s2Start) && (u->Vm[i] <= -84.5) && (time < c->s2End))
+        {
+        printf("sample %d: preparing to deliver S2 stimulus at time %f, u = %f\n", l, time, u->Vm[i]);
+        nextStim[l] = time;
+        }
+      if ((nextStim[l] > 0) && (time < nextStim[l] + 2.0) && (time >= nextStim[l]))
+        S2stimFlag[l] = 1;
+      if ((nextStim[l] > 0) && (time >= nextStim[l] + 2.0))
+        nextStim[l] = 0;
+      }
+
+    /* reaction step, SIMD_BLOCK lanes at a time; the lanes of */
+    /* neighbouring nodes follow on from each other, so every block */
+    /* is full and is worked on in place */
+#pragma omp parallel for schedule(dynamic, OMP_CHUNK/SIMD_BLOCK) private(i, j0, nb, n, m, k, l, ko, kmax, kblock, cls, dV, U, Ub, laneDt, laneStim, laneK, laneActive, laneIion)
+    for (b = 0; b < numBlocks; b++)
+      {
+      j0 = 1 + b * SIMD_BLOCK;
+      nb = (NS - j0 + 1 < SIMD_BLOCK) ? NS - j0 + 1 : SIMD_BLOCK;
+      kblock = 0;
+      for (l = 0; l < nb; l++)
+        {
+        i = j0 + l;
+        u->Vm[i] = new_Vm[i];
+        laneStim[l] = 0.0;
+        laneK[l] = 0;
+        laneDt[l] = dtlong;
+        if (!excitable[i])
+          continue;
+
+        n = (i - 1) / S + 1;
+        if (((S1stimFlag == 1) || (S2stimFlag[(i - 1) % S] == 1)) && inStim[n])
+          laneStim[l] = -52.0;
+
+        if (dVdt[i] > 0.01) ko = 5; else ko = 1;
+        kmax = ko + floor(fabs(dVdt[i]) * 20.0);
+        if (kmax > ceil(dtlong/0.01))
+          kmax = dtlong/0.01;
+
+        laneK[l] = kmax;
+        laneDt[l] = dtlong / (double) kmax;
+        if (kmax > kblock) kblock = kmax;
+        }
+      if (kblock == 0)
+        continue;
+
+      for (m = 1; m <= num_states; m++)
+        Ub[m] = &u->var[m][j0];
+
+      /* class of the nodes in the block, -1 if there is more than one */
+      cls = cells->cls[(j0 - 1) / S + 1];
+      for (l = 1; l < nb; l++)
+        if (cells->cls[(j0 + l - 1) / S + 1] != cls)
+          cls = -1;
+
+      if ((kernel == KERNEL_SIMD) && (cls >= 0))
+        {
+        for (k = 1; k <= kblock; k++)
+          {
+          for (l = 0; l < nb; l++)
+            laneActive[l] = (k <= laneK[l]);
+
+          calculate_TP06_current_OpSplit_block( Ub, nb, laneDt, laneActive, lookup, cells, cls, laneStim, laneIion );
+
+          for (l = 0; l < nb; l++)
+            if (laneActive[l])
+              Ub[V][l] = Ub[V][l] - laneDt[l] * laneIion[l];
+          }
+        }
+      else
+        {
+        for (l = 0; l < nb; l++)
+          {
+          n = (j0 + l - 1) / S + 1;
+          for (m = 1; m <= num_states; m++)
+            U[m] = Ub[m][l];
+          for (k = 1; k <= laneK[l]; k++)
+            {
+            dV = laneDt[l] * calculate_TP06_current_OpSplit( U, laneDt[l], lookup, cells, cells->cls[n], laneStim[l] );
+            U[V] = U[V] - dV;
+            }
+          for (m = 1; m <= num_states; m++)
+            Ub[m][l] = U[m];
+          }
+        }
+      }
+
+    diffusion_2D_step( stencil, u->Vm, new_Vm, old_Vm, dVdt, half_dtlong );
+
+    /* detect upstrokes and downstrokes */
+    if (time >= lastS1)
+      {
+      for (i = 1; i <= NS; i++)
+        {
+        if (!excitable[i])
+          continue;
+        if ((new_Vm[i] > threshold) && (old_Vm[i] <= threshold) && (upStrokeTime[i][beat[i]] < 0))
+          upStrokeTime[i][beat[i]] = time;
+        if ((new_Vm[i] < threshold) && (old_Vm[i] >= threshold) && (upStrokeTime[i][beat[i]] > 0))
+          {
+          downStrokeTime[i][beat[i]] = time;
+          if (beat[i] < numS1Beats)
+            beat[i]++;
+          }
+        }
+      }
+
+    if (modf(time/c->egInterval, &timems) == 0.0)
+      {
+      for (l = 0; l < S; l++)
+        {
+        for (k = 0; k < numProbes; k++)
+          egValues[k] = (egIndex[l][k] > 0) ? new_Vm[egIndex[l][k]] : 0.0;
+        queue_electrogram_2D( writer[l], timems * c->egInterval, egValues, numProbes );
+        }
+      }
+
+    if (modf(time/c->snapInterval, &timems) < 0.0001)
+      {
+      for (l = 0; l < S; l++)
+        {
+        for (n = 1; n <= RC; n++)
+          Vs[n] = u->Vm[(n-1)*S + 1 + l];
+        queue_snapshot_2D( writer[l], Vs, (int) (stfcount*c->snapInterval + 0.5), time );
+        }
+      stfcount++;
+      }
+    }
+  printf("leaving main loop\n");
+
+  /* upstroke and downstroke times, and D, for each sample */
+  Dout = fvector(1, RC);
+  for (l = 0; l < S; l++)
+    {
+    geomOut = writer[l]->geom;
+    free_writer_2D(writer[l]);
+    fclose(egPtr[l]);
+    close_snapshots_2D(snap[l]);
+
+    for (m = 1; (m <= 4) && (m <= numBeats); m++)
+      {
+      for (n = 1; n <= RC; n++)
+        Vs[n] = upStrokeTime[(n-1)*S + 1 + l][m];
+      sprintf(fname, "%s%supStrokeTimeS%d.stf", prefix[l], c->outputRoot, m);
+      writeData(fname, Vs, geomOut, nrows, ncols);
+
+      for (n = 1; n <= RC; n++)
+        Vs[n] = downStrokeTime[(n-1)*S + 1 + l][m];
+      sprintf(fname, "%s%sdownStrokeTimeS%d.stf", prefix[l], c->outputRoot, m);
+      writeData(fname, Vs, geomOut, nrows, ncols);
+      }
+
+    for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+      if (geom[l][row][col] > 0)
+        Dout[(row - 1) * ncols + col] = D[l][geom[l][row][col]];
+    sprintf(fname, "%s%sdiffusion.stf", prefix[l], c->outputRoot);
+    writeData(fname, Dout, geomOut, nrows, ncols);
+
+    free_imatrix(geomOut, 1, nrows, 1, ncols);
+    free_imatrix(geom[l], 1, nrows, 1, ncols);
+    free_fvector(D[l], 1, RC);
+    free(prefix[l]);
+    }
+
+  /* Free memory */
+  free_fvector(Dout, 1, RC);
+  free_fvector(Vs, 1, RC);
+  free_stencil_2D(stencil);
+  free_state_2D(u);
+  free_avector(dVdt, 1, NS);
+  free_avector(new_Vm, 1, NS);
+  free_avector(old_Vm, 1, NS);
+  free_ivector(excitable, 1, NS);
+  free_ivector(inStim, 1, RC);
+  free_cellmap_2D(cells);
+  free_ivector(beat, 1, NS);
+  free_fmatrix(upStrokeTime, 1, NS, 1, numBeats);
+  free_fmatrix(downStrokeTime, 1, NS, 1, numBeats);
+  free_ivector(numNodes, 0, S-1);
+  free(geom);
+  free(D);
+  free(sample);
+
+  return (0);
+}
@@ -31,20 +31,25 @@
 
 #include <TP06_OpSplit_2D.h>
 
-double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, int celltype, double stimCurrent )
+/* compiled into calculate_TP06_current_OpSplit() once for each */
+/* parameter set, so that the parameters are constants, and once */
+/* more for nodes with scaled GNa, GKs and GCaL and their own ATP */
+
+TP06_INLINE double tp06_current( double *U, double dt, lookup_2D *lookup, double stimCurrent,
+                                 const tp06_par *par, double gNaScale, double gKsScale, double gCaLScale,
+                                 double atpi )
 {
 
 /* This function returns the total current flow for element n */
 /* Includes parameters for four variants as described in TP06
- * paper, with different values for GKr, GKs, GpCa, GpK, and tau_f.
- * Parameter set 2 is equivalent to 'default' epicardial cells. */
+ * paper, with different values for GKr, GKs, GpCa, GpK, and tau_f,
+ * given by par (see tp06_parameter_set in TP06_OpSplit_2D.h).
+ * Parameter set 2 is equivalent to 'default' epicardial cells.
+ * GNa, GKs and GCaL are scaled, and intracellular ATP set, for each
+ * node by the cell parameter maps (see cellmap_2D.c). */
 
 /* based on codes at https://tbb.bio.uu.nl/khwjtuss/SourceCodes/HVM2/Source/ */
 
-	int Vmhi, Vmlo, Vmlo_diff;
-	int gain = GAIN;
-	int offset = VMOFFSET;
-
   /* Indices for u array */
   int V =      1;
   int M =      2;
@@ -68,45 +73,23 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
   int Ki =    20;
 
 
-  /* indices for lookup table */
-	int na_h_exp       = 1;
-	int na_h_inf       = 2;
-	int na_j_exp       = 3;
-	int na_j_inf       = 4;
-	int na_m_exp       = 5;
-	int na_m_inf       = 6;
-	int ca_d_exp       = 7;
-	int ca_d_inf       = 8;
-	int ca_f_exp       = 9;
-	int ca_f_inf       = 10;
-	int ca_f2_exp      = 11;
-	int ca_f2_inf      = 12;
-	int k_xr1_exp      = 13;
-	int k_xr1_inf      = 14;
-	int k_xr2_exp      = 15;
-	int k_xr2_inf      = 16;
-	int k_xs_exp       = 17;
-	int k_xs_inf       = 18;
-	int to_r_epi_inf   = 19;
-	int to_r_epi_exp   = 20;
-	int to_s_epi_inf   = 21;
-	int to_s_epi_exp   = 22;
-	int to_r_endo_inf  = 23;
-	int to_r_endo_exp  = 24;
-	int to_s_endo_inf  = 25;
-	int to_s_endo_exp  = 26;
-	int to_r_M_inf     = 27;
-	int to_r_M_exp     = 28;
-	int to_s_M_inf     = 29;
-	int to_s_M_exp     = 30;
+  /* inf of each gate in a record of the gate table, followed by */
+  /* exp(-dt/tau), see create_lookup_2D() */
+	const int rec_m = 0, rec_h = 2, rec_j = 4, rec_d = 6, rec_f = 8, rec_f2 = 10;
+	const int rec_xr1 = 12, rec_xr2 = 14, rec_xs = 16, rec_r = 18, rec_s = 20;
+	const lookup_t *rec;
+	int k;
+
+  /* terms of the voltage table, see create_volt_table() */
+	const int vt_cal_a = 0, vt_cal_b = 1, vt_ipK = 2, vt_iNaK = 3, vt_naca2 = 4;
+	const int vt_enn = 5, vt_enn1 = 6;
+	double term[NUM_VTERMS];
 
   /* Terms for Solution of Conductance and Reversal Potential */
  	const double Rgas = 8314.472;      /* Universal Gas Constant (J/kmol*K) */
   	const double Frdy = 96485.3415;  /* Faraday's Constant (C/mol) */
   	const double Temp = 310.0;    /* Temperature (K) 37C */
-  	double RTonF = (Rgas * Temp) / Frdy;
-  	double FonRT = 1.0/RTonF;
-  	double VmoRTonF = U[V]/RTonF;
+  	const double RTonF = (Rgas * Temp) / Frdy;
 
 //	Cellular capacitance
 	const double CAPACITANCE = 0.185; // NOT uF!
@@ -147,11 +130,7 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 
 //	Parameters for currents
 //	Parameters for IKr
-	double Gkr;
-	const double GkrPar1=0.134;
-	const double GkrPar2=0.153;
-	const double GkrPar3=0.172;
-	const double GkrPar4=0.172;
+	const double Gkr = par->Gkr;
 
 //	Parameters for Iks
 	const double pKNa=0.03;
@@ -159,10 +138,6 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	const double GksEpi=0.392;
 	const double GksEndo=0.392;
 	const double GksMcell=0.098;
-	double GksPar1=0.270;
-	const double GksPar2=0.392;
-	const double GksPar3=0.441;
-	const double GksPar4=0.441;
 
 //	Parameters for Ik1
 	const double GK1=5.405;
@@ -172,7 +147,7 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	const double GtoEndo=0.073;
 	const double GtoMcell=0.294;
 //	Parameters for INa
-	const double GNa=14.838; // nS/PF
+	const double GNa=14.838*gNaScale; // nS/PF
 	const double INa_Vshift = 0.0; // -3.4 for acid conditions;
 //	Parameters for IbNa
 	const double GbNa=0.00029;
@@ -181,7 +156,7 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	const double KmNa=40.0;
 	const double knak=2.724;
 //	Parameters for ICaL
-	const double GCaL=0.00003980;
+	const double GCaL=0.00003980*gCaLScale;
 	const double GCaL_atp = 1.0; //0.87 for atpi 3.0 mM
 	const double GCaL_pH = 1.0;//0.922 for pHi = pHo = 7.09
 //	Parameters for IbCa
@@ -191,21 +166,11 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	const double knaca=1000;
 	const double KmNai=87.5;
 	const double KmCa=1.38;
-	const double ksat=0.1;
-	const double nn=0.35;
 //	Parameters for IpCa
-	double GpCa;
-	const double GpCaPar1=0.0619;
-	const double GpCaPar2=0.1238;
-	const double GpCaPar3=0.3714;
-	const double GpCaPar4=0.8666;
+	const double GpCa = par->GpCa;
 	const double KpCa=0.0005;
 //	Parameters for IpK;
-	double GpK;
-	const double GpKPar1=0.0730;
-	const double GpKPar2=0.0146;
-	const double GpKPar3=0.0073;
-	const double GpKPar4=0.00219;
+	const double GpK = par->GpK;
 	const double inverseVcF2=1.0/(2.0*Vc*Frdy);
 	const double inverseVcF=1.0/(Vc*Frdy);
 	const double inversevssF2=1.0/(2.0*Vss*Frdy);
@@ -217,7 +182,7 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	                              //of the ATP-sensitive K channel (nS/uF) */
 	double patp;     		   /* Percentage availibility of open channels */
 	const double natp = 0.24;  /* K dependence of ATP-sensitive K current */
-	const double atpi = 6.8;   // 4.6 ischaemia or 6.8 normal  /* Intracellular ATP concentraion (mM) */
+	// atpi, 4.6 ischaemia or CELL_ATP 6.8 normal  /* Intracellular ATP concentraion (mM) */
 	const double hatp = 2.0;   /* Hill coefficient */
 	const double katp = 0.042; // 0.25 ischaemia, 0.042 normal /* Half-maximal saturation point of
 		                       // ATP-sensitive K current (mM) */
@@ -248,26 +213,18 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	double IKatp;
 
   /* activation and inactivation parameters */
-	double tau_h, h_inf;
-  	double tau_j, j_inf;
-  	double tau_m, m_inf;
-  	double d_inf, tau_d;
-    double f_inf, tau_f;
-	// adjust for different parameters
-    
-    //const double tau_f_multiplier = 0.6; // par 1
-	//const double tau_f_multiplier = 1.0; // par 2
-	//const double tau_f_multiplier = 1.5; // par 3
-	const double tau_f_multiplier = 2.0; // par 4
-	//const double tau_f_multiplierR2 = 1.0; // par R2
-    //const double tau_f_multiplierR1 = 0.5; // par R1
-    double f2_inf, tau_f2;
+	double h_inf;
+  	double j_inf;
+  	double m_inf;
+  	double d_inf;
+    double f_inf;
+    double f2_inf;
     double fCass_inf, tau_fCass;
-	double xr1_inf, tau_xr1;
- 	double xr2_inf, tau_xr2;
-  	double xs_inf, tau_xs;
-	double r_inf, tau_r;
-	double s_inf, tau_s;
+	double xr1_inf;
+ 	double xr2_inf;
+  	double xs_inf;
+	double r_inf;
+	double s_inf;
 
   /* Reversal potentials */
   	double Ena = RTonF*log(Nao/U[Nai]);
@@ -310,33 +267,23 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	double axr2, bxr2;
 	double axs, bxs;
 
-/* inhomogeneity parameter for 200 x 3 geometry */
-	//int m;
+/* sub-step of the lookup table time step, dt = lookup->dt / k */
+	k = lookup_substep_2D( lookup, dt );
+	lookup_volt_2D( lookup, U[V], term );
 
-	//if (n<=200) m = n;
-	//else if (n<=400) m = n-200;
-	//else m = n-400;
-
-	//GksPar1 = GksPar1 + ((double) m)/200.0;
-
-/* lookup table indices */
+/* lookup table record */
 
 	// for INa shift by up to -3.4 mV
-  	Vmhi = ceil(U[V]+INa_Vshift) * gain + offset;
-  	Vmlo_diff = U[V]+INa_Vshift - floor(U[V]+INa_Vshift);
-  	Vmlo = floor(U[V]+INa_Vshift) * gain + offset;
+	rec = lookup_record_2D( lookup, k, U[V]+INa_Vshift );
 
   /* Inward current iNa */
   /* lookup table code */
   	
-  	m_inf = lookup[na_m_inf][Vmlo] + Vmlo_diff * (lookup[na_m_inf][Vmhi] - lookup[na_m_inf][Vmlo]);
-  	tau_m = lookup[na_m_exp][Vmlo] + Vmlo_diff * (lookup[na_m_exp][Vmhi] - lookup[na_m_exp][Vmlo]);
+  	m_inf = rec[rec_m];
 
-  	h_inf = lookup[na_h_inf][Vmlo] + Vmlo_diff * (lookup[na_h_inf][Vmhi] - lookup[na_h_inf][Vmlo]);
-  	tau_h = lookup[na_h_exp][Vmlo] + Vmlo_diff * (lookup[na_h_exp][Vmhi] - lookup[na_h_exp][Vmlo]);
+  	h_inf = rec[rec_h];
 
-  	j_inf = lookup[na_j_inf][Vmlo] + Vmlo_diff * (lookup[na_j_inf][Vmhi] - lookup[na_j_inf][Vmlo]);
-  	tau_j = lookup[na_j_exp][Vmlo] + Vmlo_diff * (lookup[na_j_exp][Vmhi] - lookup[na_j_exp][Vmlo]);
+  	j_inf = rec[rec_j];
 	
 	/*
   	alpha_m = 1.0/(1.0+exp((-60.0-U[V])/5.0));
@@ -371,29 +318,24 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	j_inf = h_inf;
 	*/
 
-  	U[M] = m_inf - ( m_inf - U[M] ) * exp( -dt / tau_m );
-  	U[H] = h_inf - ( h_inf - U[H] ) * exp( -dt / tau_h );
-	U[J] = j_inf - ( j_inf - U[J] ) * exp( -dt / tau_j );
+  	U[M] = m_inf - ( m_inf - U[M] ) * rec[rec_m + 1];
+  	U[H] = h_inf - ( h_inf - U[H] ) * rec[rec_h + 1];
+	U[J] = j_inf - ( j_inf - U[J] ) * rec[rec_j + 1];
 
   	INa = GNa*U[M]*U[M]*U[M]*U[H]*U[J]*(U[V]-Ena);
 
-  	Vmhi = ceil(U[V]) * gain + offset;
-  	Vmlo_diff = U[V] - floor(U[V]);
-  	Vmlo = floor(U[V]) * gain + offset;
+	rec = lookup_record_2D( lookup, k, U[V] );
 
   /* Currents in Ca channels */
   /* lookup table code */
   	
-	d_inf = lookup[ca_d_inf][Vmlo] + Vmlo_diff * (lookup[ca_d_inf][Vmhi] - lookup[ca_d_inf][Vmlo]);
-  	tau_d = lookup[ca_d_exp][Vmlo] + Vmlo_diff * (lookup[ca_d_exp][Vmhi] - lookup[ca_d_exp][Vmlo]);
+	d_inf = rec[rec_d];
 
-  	f_inf = lookup[ca_f_inf][Vmlo] + Vmlo_diff * (lookup[ca_f_inf][Vmhi] - lookup[ca_f_inf][Vmlo]);
-  	tau_f = lookup[ca_f_exp][Vmlo] + Vmlo_diff * (lookup[ca_f_exp][Vmhi] - lookup[ca_f_exp][Vmlo]);
+  	f_inf = rec[rec_f];
 
-	if (U[V] >= 0) tau_f *= tau_f_multiplier; // Vm >= 0 added 20/12/2010
+	// tau_f *= par->tau_f_multiplier for Vm >= 0 (added 20/12/2010) is in the table
 
-  	f2_inf = lookup[ca_f2_inf][Vmlo] + Vmlo_diff * (lookup[ca_f2_inf][Vmhi] - lookup[ca_f2_inf][Vmlo]);
-  	tau_f2 = lookup[ca_f2_exp][Vmlo] + Vmlo_diff * (lookup[ca_f2_exp][Vmhi] - lookup[ca_f2_exp][Vmlo]);
+  	f2_inf = rec[rec_f2];
 	
 	/*
     d_inf = 1.0/(1.0+exp((-8.0-U[V])/7.5));
@@ -418,21 +360,20 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	fCass_inf = 0.6/(1.0+(U[CaSS]/0.05)*(U[CaSS]/0.05))+0.4;
 	tau_fCass = 80.0/(1.0+(U[CaSS]/0.05)*(U[CaSS]/0.05))+2.0;
 
-    U[D] = d_inf - (d_inf - U[D]) * exp( -dt / tau_d );
-  	U[F] = f_inf - (f_inf - U[F]) * exp( -dt / tau_f );
-  	U[F2] = f2_inf - (f2_inf - U[F2]) * exp( -dt / tau_f2 );
+    U[D] = d_inf - (d_inf - U[D]) * rec[rec_d + 1];
+  	U[F] = f_inf - (f_inf - U[F]) * rec[rec_f + 1];
+  	U[F2] = f2_inf - (f2_inf - U[F2]) * rec[rec_f2 + 1];
   	U[FCass] = fCass_inf - (fCass_inf - U[FCass]) * exp( -dt / tau_fCass );
 
-  	ICaL = GCaL_pH*GCaL_atp*GCaL*U[D]*U[F]*U[F2]*U[FCass]*4.0*(U[V]-15.0)*(Frdy/RTonF)*(0.25*exp(2.0*(U[V]-15.0)/RTonF)*U[CaSS]-Cao)/(exp(2.0*(U[V]-15.0)/RTonF)-1.0);
+  	//ICaL = GCaL_pH*GCaL_atp*GCaL*U[D]*U[F]*U[F2]*U[FCass]*4.0*(U[V]-15.0)*(Frdy/RTonF)*(0.25*exp(2.0*(U[V]-15.0)/RTonF)*U[CaSS]-Cao)/(exp(2.0*(U[V]-15.0)/RTonF)-1.0);
+  	ICaL = GCaL_pH*GCaL_atp*GCaL*U[D]*U[F]*U[F2]*U[FCass]*(term[vt_cal_a]*U[CaSS]-term[vt_cal_b]);
 
   /* Rapidly inactivating K current */
   /* lookup table code */
   	
-	xr1_inf = lookup[k_xr1_inf][Vmlo] + Vmlo_diff * (lookup[k_xr1_inf][Vmhi] - lookup[k_xr1_inf][Vmlo]);
-	tau_xr1 = lookup[k_xr1_exp][Vmlo] + Vmlo_diff * (lookup[k_xr1_exp][Vmhi] - lookup[k_xr1_exp][Vmlo]);
+	xr1_inf = rec[rec_xr1];
 
-	xr2_inf = lookup[k_xr2_inf][Vmlo] + Vmlo_diff * (lookup[k_xr2_inf][Vmhi] - lookup[k_xr2_inf][Vmlo]);
-	tau_xr2 = lookup[k_xr2_exp][Vmlo] + Vmlo_diff * (lookup[k_xr2_exp][Vmhi] - lookup[k_xr2_exp][Vmlo]);
+	xr2_inf = rec[rec_xr2];
     
 	/*
     xr1_inf = 1.0/(1.0+exp((-26.0-U[V])/7.0));
@@ -446,17 +387,14 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
     tau_xr2 = axr2 * bxr2;
 	*/ 
 
- 	Gkr = GkrPar4;
- 	U[Xr1] = xr1_inf - (xr1_inf - U[Xr1]) * exp( -dt / tau_xr1 );
- 	U[Xr2] = xr2_inf - (xr2_inf - U[Xr2]) * exp( -dt / tau_xr2 );
+ 	U[Xr1] = xr1_inf - (xr1_inf - U[Xr1]) * rec[rec_xr1 + 1];
+ 	U[Xr2] = xr2_inf - (xr2_inf - U[Xr2]) * rec[rec_xr2 + 1];
 	IKr = Gkr*sqrt(Ko/5.4)*U[Xr1]*U[Xr2]*(U[V]-Ek);
 
   /* Slowly inactivating K current */
-  /* celltype is 0 (endo) 2 (epi) or 1 (M) */
   /* lookup table code */
 	
-  	xs_inf = lookup[k_xs_inf][Vmlo] + Vmlo_diff * (lookup[k_xs_inf][Vmhi] - lookup[k_xs_inf][Vmlo]);
-	tau_xs = lookup[k_xs_exp][Vmlo] + Vmlo_diff * (lookup[k_xs_exp][Vmhi] - lookup[k_xs_exp][Vmlo]);
+  	xs_inf = rec[rec_xs];
 	
 	/*
 	xs_inf = 1.0/(1.0+exp((-5.0-U[V])/14.0));
@@ -465,12 +403,11 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	tau_xs = axs * bxs + 80.0;
 	*/
 
-	U[Xs] = xs_inf - (xs_inf - U[Xs]) * exp( -dt / tau_xs );
+	U[Xs] = xs_inf - (xs_inf - U[Xs]) * rec[rec_xs + 1];
 
-	//if (celltype == 0) { Gks = GksEndo; }
-	//else if (celltype == 1) { Gks = GksMcell; }
-	//else  {Gks = GksEpi; }
-	Gks = GksPar4;
+	// endo, M and epi cells (GksEndo, GksMcell, GksEpi), or a gradient
+	// in Gks, are set with a GKs map (gksmap)
+	Gks = par->Gks*gKsScale;
 	IKs = Gks*U[Xs]*U[Xs]*(U[V]-Eks);
 
   /* Time independent K current */
@@ -480,21 +417,17 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	IK1 = GK1*rec_iK1*(U[V] - Ek);
 
   /* Plateau K current */
-  	GpK=GpKPar4;
-	rec_ipK = 1.0/(1.0+exp((25.0-U[V])/5.98));
+	rec_ipK = term[vt_ipK]; // 1.0/(1.0+exp((25.0-U[V])/5.98))
 	IpK=GpK*rec_ipK*(U[V]-Ek);
 
   /* transient outward current */
-  /* celltype is 0 (endo) 2 (epi) or 1 (M) */
 
   /* EPI only code */
 
 	/* lookup table code */
 		
-	r_inf = lookup[to_r_epi_inf][Vmlo] + Vmlo_diff * (lookup[to_r_epi_inf][Vmhi] - lookup[to_r_epi_inf][Vmlo]);
-	tau_r = lookup[to_r_epi_exp][Vmlo] + Vmlo_diff * (lookup[to_r_epi_exp][Vmhi] - lookup[to_r_epi_exp][Vmlo]);
-	s_inf = lookup[to_s_epi_inf][Vmlo] + Vmlo_diff * (lookup[to_s_epi_inf][Vmhi] - lookup[to_s_epi_inf][Vmlo]);
-	tau_s = lookup[to_s_epi_exp][Vmlo] + Vmlo_diff * (lookup[to_s_epi_exp][Vmhi] - lookup[to_s_epi_exp][Vmlo]);
+	r_inf = rec[rec_r];
+	s_inf = rec[rec_s];
 
 	/*
 	r_inf = 1.0/(1.0+exp((20.0-U[V])/6.0));
@@ -505,8 +438,8 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 
 	Gto = GtoEpi;
 
-	U[S] = s_inf - (s_inf - U[S]) * exp(-dt / tau_s);
-	U[R] = r_inf - (r_inf - U[R]) * exp(-dt / tau_r);
+	U[S] = s_inf - (s_inf - U[S]) * rec[rec_s + 1];
+	U[R] = r_inf - (r_inf - U[R]) * rec[rec_r + 1];
 	Ito = Gto*U[R]*U[S]*(U[V]-Ek);
 
 
@@ -519,8 +452,8 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 
   /* Na Ca exchanger */
 	naca1 = knaca*(1.0/(KmNai*KmNai*KmNai+Nao3))*(1.0/(KmCa+Cao));
-	naca2 = (1.0/(1.0+ksat*exp((nn-1.0)*VmoRTonF)));
-	naca3 = (exp(nn*VmoRTonF)*U[Nai]*U[Nai]*U[Nai]*Cao-exp((nn-1.0)*VmoRTonF)*Nao3*U[Cai]*2.5);
+	naca2 = term[vt_naca2]; // (1.0/(1.0+ksat*exp((nn-1.0)*VmoRTonF))), ksat and nn in create_TP06_lookup_OpSplit_2D.c
+	naca3 = (term[vt_enn]*U[Nai]*U[Nai]*U[Nai]*Cao-term[vt_enn1]*Nao3*U[Cai]*2.5);
 	INaCa = naca_pH * naca1 * naca2 * naca3;
 
 	//INaCa=knaca*(1.0/(KmNai*KmNai*KmNai+Nao3))*(1.0/(KmCa+Cao))*(1.0/(1.0+ksat*exp((nn-1.0)*VmoRTonF)))*(exp(nn*VmoRTonF)*U[Nai]*U[Nai]*U[Nai]*Cao-exp((nn-1.0)*VmoRTonF)*Nao3*Cai*2.5);
@@ -529,11 +462,10 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	IbNa=GbNa*(U[V]-Ena);
 
   /* iNaK */
-	rec_iNaK = (1.0/(1.0+0.1245*exp(-0.1*VmoRTonF)+0.0353*exp(-VmoRTonF)));
+	rec_iNaK = term[vt_iNaK]; // (1.0/(1.0+0.1245*exp(-0.1*VmoRTonF)+0.0353*exp(-VmoRTonF)))
 	INaK=knak*(Ko/(Ko+KmK))*(U[Nai]/(U[Nai]+KmNa))*rec_iNaK;
 
   /* Plateau Ca current */
- 	GpCa=GpCaPar4;
   	IpCa=GpCa*U[Cai]/(KpCa+U[Cai]);
 
   /* Background Ca current */
@@ -580,3 +512,34 @@ double calculate_TP06_current_OpSplit( double *U, double dt, double **lookup, in
 	return( IKr + IKs + IK1 + Ito + IKatp + INa + IbNa + ICaL + IbCa + INaK + INaCa + IpCa + IpK + stimCurrent );
 
 }
+
+/***************************************************************
+
+ calculate_TP06_current_OpSplit
+
+ advances the state U of one node by dt, with the parameter set
+ the lookup table was made for and the parameters of class cls
+ in map (the normal cell if map is NULL or cls is 0), and returns
+ the total current
+
+***************************************************************/
+
+double calculate_TP06_current_OpSplit( double *U, double dt, lookup_2D *lookup, const cellmap_2D *map, int cls,
+                                       double stimCurrent )
+{
+  if ((map == NULL) || (cls == 0))
+    switch (lookup->par)
+      {
+      case 1:
+        return tp06_current( U, dt, lookup, stimCurrent, &tp06_parameter_set[0], 1.0, 1.0, 1.0, CELL_ATP );
+      case 2:
+        return tp06_current( U, dt, lookup, stimCurrent, &tp06_parameter_set[1], 1.0, 1.0, 1.0, CELL_ATP );
+      case 3:
+        return tp06_current( U, dt, lookup, stimCurrent, &tp06_parameter_set[2], 1.0, 1.0, 1.0, CELL_ATP );
+      default:
+        return tp06_current( U, dt, lookup, stimCurrent, &tp06_parameter_set[3], 1.0, 1.0, 1.0, CELL_ATP );
+      }
+
+  return tp06_current( U, dt, lookup, stimCurrent, &tp06_parameter_set[lookup->par - 1],
+                       map->gNa[cls], map->gKs[cls], map->gCaL[cls], map->atp[cls] );
+}
@@ -0,0 +1,588 @@
+/********************************************************************
+
+ calculate_TP06_current_OpSplit_block.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/* The selects in this file must be turned into vector blends rather
+   than branches, which gcc will only do if floating point operations
+   are allowed to be evaluated speculatively. sqrt() is only inlined
+   as a vector instruction when the whole program is compiled with
+   -fno-math-errno (see README.md) */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("no-trapping-math")
+#endif
+
+#include <stdint.h>
+#include "TP06_OpSplit_2D.h"
+
+/* compile the block kernel for AVX-512, AVX2 and baseline x86-64, and
+   pick the best version for the processor at run time */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define SIMD_TARGETS __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define SIMD_TARGETS
+#endif
+
+/***************************************************************
+
+ tp06_exp, tp06_log
+
+ branch-free exp() and log() that the compiler can vectorise.
+ Accurate to about 1 ulp over the range used by the model.
+
+***************************************************************/
+
+TP06_INLINE double tp06_exp( double x )
+{
+  const double shift = 6755399441055744.0;      /* 1.5 * 2^52 */
+  const double ln2hi = 6.93147180369123816490e-01;
+  const double ln2lo = 1.90821492927058770002e-10;
+  double kd, r, p, s;
+  int64_t bits;
+
+  x = (x > 708.0) ? 708.0 : x;
+  x = (x < -708.0) ? -708.0 : x;
+
+  /* x = k ln2 + r, with k held in the low bits of kd */
+  kd = x * 1.4426950408889634074 + shift;
+  memcpy(&bits, &kd, sizeof(double));
+  kd -= shift;
+  r = (x - kd * ln2hi) - kd * ln2lo;
+
+  p = 1.0 + r*(1.0 + r*(1.0/2.0 + r*(1.0/6.0 + r*(1.0/24.0 + r*(1.0/120.0
+      + r*(1.0/720.0 + r*(1.0/5040.0 + r*(1.0/40320.0 + r*(1.0/362880.0
+      + r*(1.0/3628800.0 + r*(1.0/39916800.0 + r*(1.0/479001600.0))))))))))));
+
+  /* scale by 2^k */
+  bits = (bits + 1023) << 52;
+  memcpy(&s, &bits, sizeof(double));
+
+  return( p * s );
+}
+
+TP06_INLINE double tp06_log( double x )
+{
+  const double shift = 4503599627370496.0;      /* 2^52 */
+  const double ln2hi = 6.93147180369123816490e-01;
+  const double ln2lo = 1.90821492927058770002e-10;
+  int64_t bits, ebits;
+  double m, e, f, s, s2, p, hi;
+
+  /* x = 2^e * m, with m in [sqrt(1/2), sqrt(2)) */
+  memcpy(&bits, &x, sizeof(double));
+  ebits = ((bits >> 52) & 0x7ff) | 0x4330000000000000LL;
+  memcpy(&e, &ebits, sizeof(double));
+  e -= shift + 1023.0;
+  bits = (bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL;
+  memcpy(&m, &bits, sizeof(double));
+
+  hi = (m > 1.41421356237309504880);
+  e += hi;
+  m *= 1.0 - 0.5 * hi;
+
+  /* log(m) = 2 atanh(s), s = (m-1)/(m+1) */
+  f = m - 1.0;
+  s = f / (2.0 + f);
+  s2 = s*s;
+  p = s2*(2.0/3.0 + s2*(2.0/5.0 + s2*(2.0/7.0 + s2*(2.0/9.0 + s2*(2.0/11.0
+      + s2*(2.0/13.0 + s2*(2.0/15.0 + s2*(2.0/17.0 + s2*(2.0/19.0 + s2*(2.0/21.0))))))))));
+
+  return( e * ln2hi + ((f - s*(f - p)) + e * ln2lo) );
+}
+
+/***************************************************************
+
+ tp06_select
+
+ returns a where mask is all ones and b where it is zero, without
+ a branch or a masked store
+
+***************************************************************/
+
+TP06_INLINE double tp06_select( int64_t mask, double a, double b )
+{
+  int64_t ia, ib;
+
+  memcpy(&ia, &a, sizeof(double));
+  memcpy(&ib, &b, sizeof(double));
+  ia = (ia & mask) | (ib & ~mask);
+  memcpy(&a, &ia, sizeof(double));
+
+  return( a );
+}
+
+/***************************************************************
+
+ calculate_TP06_current_OpSplit_block
+
+ Advances nb nodes (nb <= SIMD_BLOCK) by one Rush-Larsen step at
+ once. Ub[m][l] is state variable m of lane l, dt[l] the time step
+ for that lane, and only lanes with active[l] != 0 are updated.
+ dt[l] must be one of the sub-steps the gate table was made for
+ (dt/k, k = 1..ceil(dt/0.01), as in main() and batch_2D.c), since
+ exp(-dt/tau) for the gates is taken from the table.
+ All the lanes are nodes of class cls in map (the normal cell if
+ map is NULL or cls is 0, see cellmap_2D.c).
+ The total current of each lane is returned in Iion[l].
+
+ This is the same model as calculate_TP06_current_OpSplit(), with
+ every statement applied across the lanes so that the compiler can
+ vectorise the loop. Results agree with the scalar routine to
+ rounding (see validate_TP06_block_kernel()).
+
+***************************************************************/
+
+/* compiled into calculate_TP06_current_OpSplit_block() once for */
+/* each parameter set, and once more for scaled cells, as */
+/* tp06_current() in the scalar routine */
+TP06_INLINE void tp06_block( double **Ub, int nb, const double *dt, const int *active,
+                             lookup_2D *lookup, const double *stimCurrent, double *Iion, const tp06_par *par,
+                             double gNaScale, double gKsScale, double gCaLScale, double atpi )
+{
+  int l;
+
+  /* Indices for u array */
+  int V =      1;
+  int M =      2;
+  int H =      3;
+  int J =      4;
+  int R =      5;
+  int S =      6;
+  int D =      7;
+  int F =      8;
+  int F2 =     9;
+  int FCass = 10;
+  int Xr1 =   11;
+  int Xr2 =   12;
+  int Xs =    13;
+  int RR =    14;
+  int OO =    15;
+  int CaSS =  16;
+  int CaSR =  17;
+  int Cai =   18;
+  int Nai =   19;
+  int Ki =    20;
+
+  /* inf of each gate in a record of the gate table, followed by */
+  /* exp(-dt/tau), see create_lookup_2D() */
+  const int rec_m = 0, rec_h = 2, rec_j = 4, rec_d = 6, rec_f = 8, rec_f2 = 10;
+  const int rec_xr1 = 12, rec_xr2 = 14, rec_xs = 16, rec_r = 18, rec_s = 20;
+
+  /* terms of the voltage table, see create_volt_table() */
+  const int vt_cal_a = 0, vt_cal_b = 1, vt_ipK = 2, vt_iNaK = 3, vt_naca2 = 4;
+  const int vt_enn = 5, vt_enn1 = 6;
+
+  /* Terms for Solution of Conductance and Reversal Potential */
+  const double Rgas = 8314.472;      /* Universal Gas Constant (J/kmol*K) */
+  const double Frdy = 96485.3415;    /* Faraday's Constant (C/mol) */
+  const double Temp = 310.0;         /* Temperature (K) 37C */
+  const double RTonF = (Rgas * Temp) / Frdy;
+
+  /* model parameters, as in calculate_TP06_current_OpSplit() (parameter set par) */
+  const double CAPACITANCE = 0.185;
+  const double Ko = 5.4;
+  const double KoNorm = 5.4;
+  const double Cao = 2.0;
+  const double Nao = 140.0;
+  const double Nao3 = 2744000.0;
+  const double Vc = 0.016403;
+  const double Vsr = 0.0010935;
+  const double Vss = 0.000054678;
+  const double Bufc = 0.2;
+  const double Kbufc = 0.001;
+  const double Bufsr = 10.0;
+  const double Kbufsr = 0.3;
+  const double Bufss = 0.4;
+  const double Kbufss = 0.00025;
+  const double Vmaxup = 0.006375;
+  const double Kup = 0.00025;
+  const double Vrel = 0.102;
+  const double k1bar = 0.15;
+  const double k2bar = 0.045;
+  const double k3 = 0.060;
+  const double k4 = 0.005;
+  const double EC = 1.5;
+  const double maxsr = 2.5;
+  const double minsr = 1.0;
+  const double Vleak = 0.00036;
+  const double Vxfer = 0.0038;
+  const double Gkr = par->Gkr;
+  const double pKNa = 0.03;
+  const double Gks = par->Gks * gKsScale;
+  const double GK1 = 5.405;
+  const double Gto = 0.294;
+  const double GNa = 14.838 * gNaScale;
+  const double GbNa = 0.00029;
+  const double KmK = 1.0;
+  const double KmNa = 40.0;
+  const double knak = 2.724;
+  const double GCaL = 0.00003980 * gCaLScale;
+  const double GCaL_atp = 1.0;
+  const double GCaL_pH = 1.0;
+  const double GbCa = 0.000592;
+  const double naca_pH = 1.0;
+  const double knaca = 1000;
+  const double KmNai = 87.5;
+  const double KmCa = 1.38;
+  const double GpCa = par->GpCa;
+  const double KpCa = 0.0005;
+  const double GpK = par->GpK;
+  const double inverseVcF2 = 1.0/(2.0*Vc*Frdy);
+  const double inverseVcF = 1.0/(Vc*Frdy);
+  const double inversevssF2 = 1.0/(2.0*Vss*Frdy);
+  const double gkatp = 3.9;
+  const double natp = 0.24;
+  const double hatp = 2.0;
+  const double katp = 0.042;
+
+  /* terms that do not depend on the state, evaluated once per block */
+  /* (as in the scalar routine, ekatp uses the index Ki rather than the */
+  /* intracellular K concentration) */
+  const double ekatp = RTonF * log(Ko/Ki);
+  const double gkbaratp = gkatp * (1.0/(1.0+(pow((atpi/katp),hatp)))) * (pow((Ko/KoNorm),natp));
+  const double sqrtKo = sqrt(Ko/5.4);
+  const double naca1 = knaca*(1.0/(KmNai*KmNai*KmNai+Nao3))*(1.0/(KmCa+Cao));
+
+  /* gate table */
+  const lookup_t *gate = lookup->gate;
+  const lookup_t *volt = lookup->volt;
+  const double dtTab = lookup->dt;
+  const int numK = lookup->numK;
+
+  double *uV = Ub[V], *uM = Ub[M], *uH = Ub[H], *uJ = Ub[J], *uR = Ub[R], *uS = Ub[S];
+  double *uD = Ub[D], *uF = Ub[F], *uF2 = Ub[F2], *uFCass = Ub[FCass];
+  double *uXr1 = Ub[Xr1], *uXr2 = Ub[Xr2], *uXs = Ub[Xs], *uRR = Ub[RR], *uOO = Ub[OO];
+  double *uCaSS = Ub[CaSS], *uCaSR = Ub[CaSR], *uCai = Ub[Cai], *uNai = Ub[Nai], *uKi = Ub[Ki];
+
+#pragma omp simd
+  for (l = 0; l < nb; l++)
+    {
+    const double dtl = dt[l];
+    const int64_t mask = -(int64_t) (active[l] != 0);
+    const double Vm = uV[l];
+    double m, hh, j, d, f, f2, fCass, xr1, xr2, xs, r, s, rr, oo, CaSS_, CaSR_, Cai_, Nai_, Ki_;
+    double Ena, Ek, Eks, Eca;
+    double IKr, IKs, IK1, Ito, INa, IbNa, ICaL, IbCa, INaCa, IpCa, IpK, INaK, IKatp;
+    double Irel, Ileak, Iup, Ixfer, k1, k2, kCaSR;
+    double m_inf, h_inf, j_inf;
+    double d_inf, f_inf, f2_inf, fCass_inf, tau_fCass;
+    double xr1_inf, xr2_inf, xs_inf, r_inf, s_inf;
+    double naca2, naca3, Ak1, Bk1, rec_iK1, rec_iNaK, rec_ipK;
+    double dRR, CaCSQN, dCaSR, bjsr, cjsr, CaSSBuf, dCaSS, bcss, ccss, CaBuf, dCai, bc, cc;
+    double x, w;
+    int e, v;
+    int bin, k;
+
+    /* Reversal potentials */
+    Ena = RTonF*tp06_log(Nao/uNai[l]);
+    Ek = RTonF*(tp06_log((Ko/uKi[l])));
+    Eks = RTonF*(tp06_log((Ko+pKNa*Nao)/(uKi[l]+pKNa*uNai[l])));
+    Eca = 0.5*RTonF*(tp06_log((Cao/uCai[l])));
+
+    /* gate table record for the voltage bin floor(Vm); as in the scalar */
+    /* routine the fractional part is discarded, so no interpolation. */
+    /* The bin and sub-step are clamped before conversion to int, so */
+    /* that the baseline x86-64 version is vectorised as well */
+    x = Vm + 1000.0;
+    x = (x < 1000.0 + LOOKUP_VMIN) ? 1000.0 + LOOKUP_VMIN : x;
+    x = (x > 1000.0 + LOOKUP_VMIN + LOOKUP_BINS - 1) ? 1000.0 + LOOKUP_VMIN + LOOKUP_BINS - 1 : x;
+    bin = (int) x - 1000 - LOOKUP_VMIN;
+
+    /* and the sub-step dt/k of this lane */
+    x = dtTab / dtl + 0.5;
+    x = (x < 1.0) ? 1.0 : ((x > numK) ? numK : x);
+    k = (int) x;
+    e = ((k - 1) * LOOKUP_BINS + bin) * LOOKUP_RECORD;
+
+    /* voltage table record below Vm, and the weight of the next point */
+    /* (as lookup_volt_2D()) */
+    x = (Vm - LOOKUP_VLOW) / LOOKUP_VSTEP;
+    v = (int) x;
+    v = (v < 0) ? 0 : v;
+    v = (v > LOOKUP_VPOINTS - 2) ? LOOKUP_VPOINTS - 2 : v;
+    w = x - v;
+    v *= LOOKUP_VRECORD;
+
+    /* Inward current iNa */
+    m_inf = gate[e + rec_m];
+    h_inf = gate[e + rec_h];
+    j_inf = gate[e + rec_j];
+
+    m = m_inf - ( m_inf - uM[l] ) * gate[e + rec_m + 1];
+    hh = h_inf - ( h_inf - uH[l] ) * gate[e + rec_h + 1];
+    j = j_inf - ( j_inf - uJ[l] ) * gate[e + rec_j + 1];
+
+    INa = GNa*m*m*m*hh*j*(Vm-Ena);
+
+    /* Currents in Ca channels */
+    d_inf = gate[e + rec_d];
+    f_inf = gate[e + rec_f];
+    f2_inf = gate[e + rec_f2];
+
+    fCass_inf = 0.6/(1.0+(uCaSS[l]/0.05)*(uCaSS[l]/0.05))+0.4;
+    tau_fCass = 80.0/(1.0+(uCaSS[l]/0.05)*(uCaSS[l]/0.05))+2.0;
+
+    d = d_inf - (d_inf - uD[l]) * gate[e + rec_d + 1];
+    f = f_inf - (f_inf - uF[l]) * gate[e + rec_f + 1];
+    f2 = f2_inf - (f2_inf - uF2[l]) * gate[e + rec_f2 + 1];
+    fCass = fCass_inf - (fCass_inf - uFCass[l]) * tp06_exp( -dtl / tau_fCass );
+
+    ICaL = GCaL_pH*GCaL_atp*GCaL*d*f*f2*fCass*((volt[v + vt_cal_a] + w*volt[v + NUM_VTERMS + vt_cal_a])*uCaSS[l]
+                                               - (volt[v + vt_cal_b] + w*volt[v + NUM_VTERMS + vt_cal_b]));
+
+    /* Rapidly inactivating K current */
+    xr1_inf = gate[e + rec_xr1];
+    xr2_inf = gate[e + rec_xr2];
+
+    xr1 = xr1_inf - (xr1_inf - uXr1[l]) * gate[e + rec_xr1 + 1];
+    xr2 = xr2_inf - (xr2_inf - uXr2[l]) * gate[e + rec_xr2 + 1];
+    IKr = Gkr*sqrtKo*xr1*xr2*(Vm-Ek);
+
+    /* Slowly inactivating K current */
+    xs_inf = gate[e + rec_xs];
+
+    xs = xs_inf - (xs_inf - uXs[l]) * gate[e + rec_xs + 1];
+    IKs = Gks*xs*xs*(Vm-Eks);
+
+    /* Time independent K current */
+    Ak1 = 0.1/(1.0+tp06_exp(0.06*(Vm-Ek-200.0)));
+    Bk1 = (3.0*tp06_exp(0.0002*(Vm-Ek+100.0))+tp06_exp(0.1*(Vm-Ek-10.0)))/(1.0+tp06_exp(-0.5*(Vm-Ek)));
+    rec_iK1 = Ak1/(Ak1+Bk1);
+    IK1 = GK1*rec_iK1*(Vm - Ek);
+
+    /* Plateau K current */
+    rec_ipK = volt[v + vt_ipK] + w*volt[v + NUM_VTERMS + vt_ipK];
+    IpK = GpK*rec_ipK*(Vm-Ek);
+
+    /* transient outward current, EPI only */
+    r_inf = gate[e + rec_r];
+    s_inf = gate[e + rec_s];
+
+    s = s_inf - (s_inf - uS[l]) * gate[e + rec_s + 1];
+    r = r_inf - (r_inf - uR[l]) * gate[e + rec_r + 1];
+    Ito = Gto*r*s*(Vm-Ek);
+
+    /* ATP dependent K current */
+    IKatp = gkbaratp*(Vm-ekatp);
+
+    /* Na Ca exchanger */
+    naca2 = volt[v + vt_naca2] + w*volt[v + NUM_VTERMS + vt_naca2];
+    naca3 = ((volt[v + vt_enn] + w*volt[v + NUM_VTERMS + vt_enn])*uNai[l]*uNai[l]*uNai[l]*Cao
+             - (volt[v + vt_enn1] + w*volt[v + NUM_VTERMS + vt_enn1])*Nao3*uCai[l]*2.5);
+    INaCa = naca_pH * naca1 * naca2 * naca3;
+
+    /* Background Na current */
+    IbNa = GbNa*(Vm-Ena);
+
+    /* iNaK */
+    rec_iNaK = volt[v + vt_iNaK] + w*volt[v + NUM_VTERMS + vt_iNaK];
+    INaK = knak*(Ko/(Ko+KmK))*(uNai[l]/(uNai[l]+KmNa))*rec_iNaK;
+
+    /* Plateau Ca current */
+    IpCa = GpCa*uCai[l]/(KpCa+uCai[l]);
+
+    /* Background Ca current */
+    IbCa = GbCa*(Vm-Eca);
+
+    /* intracellular ion concentrations */
+    kCaSR = maxsr-((maxsr-minsr)/(1.0+(EC/uCaSR[l])*(EC/uCaSR[l])));
+    k1 = k1bar/kCaSR;
+    k2 = k2bar*kCaSR;
+    dRR = k4 * (1.0-uRR[l]) - k2*uCaSS[l]*uRR[l];
+    rr = uRR[l] + dtl*dRR;
+    oo = k1*uCaSS[l]*uCaSS[l]*rr/(k3+k1*uCaSS[l]*uCaSS[l]);
+    Irel = Vrel*oo*(uCaSR[l]-uCaSS[l]);
+    Ileak = Vleak*(uCaSR[l]-uCai[l]);
+    Iup = Vmaxup/(1.0+((Kup*Kup)/(uCai[l]*uCai[l])));
+    Ixfer = Vxfer*(uCaSS[l] - uCai[l]);
+
+    CaCSQN = Bufsr*uCaSR[l]/(uCaSR[l]+Kbufsr);
+    dCaSR = dtl*(Iup-Irel-Ileak);
+    bjsr = Bufsr-CaCSQN-dCaSR-uCaSR[l]+Kbufsr;
+    cjsr = Kbufsr*(CaCSQN+dCaSR+uCaSR[l]);
+    CaSR_ = (sqrt(bjsr*bjsr+4.0*cjsr)-bjsr)/2.0;
+
+    CaSSBuf = Bufss*uCaSS[l]/(uCaSS[l]+Kbufss);
+    dCaSS = dtl*(-Ixfer*(Vc/Vss)+Irel*(Vsr/Vss)+(-ICaL*inversevssF2*CAPACITANCE));
+    bcss = Bufss-CaSSBuf-dCaSS-uCaSS[l]+Kbufss;
+    ccss = Kbufss*(CaSSBuf+dCaSS+uCaSS[l]);
+    CaSS_ = (sqrt(bcss*bcss+4.0*ccss)-bcss)/2.0;
+
+    CaBuf = Bufc*uCai[l]/(uCai[l]+Kbufc);
+    dCai = dtl*((-(IbCa+IpCa-2.0*INaCa)*inverseVcF2*CAPACITANCE)-(Iup-Ileak)*(Vsr/Vc)+Ixfer);
+    bc = Bufc-CaBuf-dCai-uCai[l]+Kbufc;
+    cc = Kbufc*(CaBuf+dCai+uCai[l]);
+    Cai_ = (sqrt(bc*bc+4.0*cc)-bc)/2.0;
+
+    Nai_ = uNai[l] + dtl*(-(INa+IbNa+3.0*INaK+3.0*INaCa)*inverseVcF*CAPACITANCE);
+    Ki_ = uKi[l] + dtl*(-(stimCurrent[l]+IK1+Ito+IKr+IKs-2.0*INaK+IpK)*inverseVcF*CAPACITANCE);
+
+    /* write back the lanes that are being advanced */
+    uM[l] = tp06_select( mask, m, uM[l] );
+    uH[l] = tp06_select( mask, hh, uH[l] );
+    uJ[l] = tp06_select( mask, j, uJ[l] );
+    uD[l] = tp06_select( mask, d, uD[l] );
+    uF[l] = tp06_select( mask, f, uF[l] );
+    uF2[l] = tp06_select( mask, f2, uF2[l] );
+    uFCass[l] = tp06_select( mask, fCass, uFCass[l] );
+    uXr1[l] = tp06_select( mask, xr1, uXr1[l] );
+    uXr2[l] = tp06_select( mask, xr2, uXr2[l] );
+    uXs[l] = tp06_select( mask, xs, uXs[l] );
+    uS[l] = tp06_select( mask, s, uS[l] );
+    uR[l] = tp06_select( mask, r, uR[l] );
+    uRR[l] = tp06_select( mask, rr, uRR[l] );
+    uOO[l] = tp06_select( mask, oo, uOO[l] );
+    uCaSR[l] = tp06_select( mask, CaSR_, uCaSR[l] );
+    uCaSS[l] = tp06_select( mask, CaSS_, uCaSS[l] );
+    uCai[l] = tp06_select( mask, Cai_, uCai[l] );
+    uNai[l] = tp06_select( mask, Nai_, uNai[l] );
+    uKi[l] = tp06_select( mask, Ki_, uKi[l] );
+
+    Iion[l] = IKr + IKs + IK1 + Ito + IKatp + INa + IbNa + ICaL + IbCa + INaK + INaCa + IpCa + IpK + stimCurrent[l];
+    }
+}
+
+SIMD_TARGETS
+void calculate_TP06_current_OpSplit_block( double **Ub, int nb, const double *dt, const int *active,
+                                           lookup_2D *lookup, const cellmap_2D *map, int cls,
+                                           const double *stimCurrent, double *Iion )
+{
+  if ((map == NULL) || (cls == 0))
+    switch (lookup->par)
+      {
+      case 1:
+        tp06_block( Ub, nb, dt, active, lookup, stimCurrent, Iion, &tp06_parameter_set[0], 1.0, 1.0, 1.0, CELL_ATP );
+        break;
+      case 2:
+        tp06_block( Ub, nb, dt, active, lookup, stimCurrent, Iion, &tp06_parameter_set[1], 1.0, 1.0, 1.0, CELL_ATP );
+        break;
+      case 3:
+        tp06_block( Ub, nb, dt, active, lookup, stimCurrent, Iion, &tp06_parameter_set[2], 1.0, 1.0, 1.0, CELL_ATP );
+        break;
+      default:
+        tp06_block( Ub, nb, dt, active, lookup, stimCurrent, Iion, &tp06_parameter_set[3], 1.0, 1.0, 1.0, CELL_ATP );
+        break;
+      }
+  else
+    tp06_block( Ub, nb, dt, active, lookup, stimCurrent, Iion, &tp06_parameter_set[lookup->par - 1],
+                map->gNa[cls], map->gKs[cls], map->gCaL[cls], map->atp[cls] );
+}
+
+/***************************************************************
+
+ validate_TP06_block_kernel
+
+ Paces a single cell with both the scalar and the block kernel
+ and reports the largest difference in each state variable.
+ Each lane is stimulated at a different time and integrated with
+ a different time step, so that the masked lanes and the tau_f
+ branch are exercised. Returns 1 if the block kernel agrees with
+ the scalar routine to within tol (relative), 0 otherwise.
+
+***************************************************************/
+
+int validate_TP06_block_kernel( lookup_2D *lookup, double tol )
+{
+  const int num_states = NUM_STATES;
+  const int V = 1;
+  const double tmax = 600.0;               // ms
+  const double dtlong = config.dt;          // ms
+  int l, m, k, kmax, step, nsteps, ok;
+
+  double *Ub[NUM_STATES + 1];
+  double block[NUM_STATES + 1][SIMD_BLOCK];
+  double U[SIMD_BLOCK][NUM_STATES + 1];
+  double dt[SIMD_BLOCK], stim[SIMD_BLOCK], Iion[SIMD_BLOCK];
+  double maxdiff[NUM_STATES + 1];
+  double time, dV, diff, scale;
+  int active[SIMD_BLOCK], kLane[SIMD_BLOCK];
+  state_2D *u;
+
+  /* initial conditions from the tissue initialisation */
+  u = create_state_2D( 1 );
+  initialise_variables_2D( u, 1 );
+  for (l = 0; l < SIMD_BLOCK; l++)
+    for (m = 1; m <= num_states; m++)
+      U[l][m] = block[m][l] = u->var[m][1];
+  free_state_2D( u );
+
+  for (m = 1; m <= num_states; m++)
+    {
+    Ub[m] = block[m];
+    maxdiff[m] = 0.0;
+    }
+
+  nsteps = tmax / dtlong;
+  for (step = 0; step < nsteps; step++)
+    {
+    time = step * dtlong;
+    kmax = 0;
+    for (l = 0; l < SIMD_BLOCK; l++)
+      {
+      kLane[l] = 1 + l % (int) ceil(dtlong/0.01);
+      dt[l] = dtlong / (double) kLane[l];
+      stim[l] = ((time >= 10.0 + 5.0*l) && (time < 12.0 + 5.0*l)) ? -52.0 : 0.0;
+      if (kLane[l] > kmax) kmax = kLane[l];
+      }
+
+    for (k = 1; k <= kmax; k++)
+      {
+      for (l = 0; l < SIMD_BLOCK; l++)
+        active[l] = (k <= kLane[l]);
+      calculate_TP06_current_OpSplit_block( Ub, SIMD_BLOCK, dt, active, lookup, NULL, 0, stim, Iion );
+      for (l = 0; l < SIMD_BLOCK; l++)
+        {
+        if (active[l])
+          {
+          block[V][l] -= dt[l] * Iion[l];
+          dV = dt[l] * calculate_TP06_current_OpSplit( U[l], dt[l], lookup, NULL, 0, stim[l] );
+          U[l][V] = U[l][V] - dV;
+          }
+        }
+      }
+
+    for (l = 0; l < SIMD_BLOCK; l++)
+      for (m = 1; m <= num_states; m++)
+        {
+        scale = (fabs(U[l][m]) > 1.0) ? fabs(U[l][m]) : 1.0;
+        diff = fabs(block[m][l] - U[l][m]) / scale;
+        if (!(diff <= maxdiff[m])) maxdiff[m] = diff;
+        }
+    }
+
+  ok = 1;
+  printf("block kernel validation, largest difference from scalar kernel:\n");
+  for (m = 1; m <= num_states; m++)
+    {
+    printf("  state %2d: %g\n", m, maxdiff[m]);
+    if (!(maxdiff[m] <= tol)) ok = 0;
+    }
+
+  return (ok);
+}
@@ -0,0 +1,231 @@
+/***************************************************************
+
+ cellmap_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ Cell parameters that vary from node to node, for transmural
+ differences or remodelling in the border zone. Each of the maps
+
+   gnamap     scaling of GNa
+   gksmap     scaling of GKs
+   gcalmap    scaling of GCaL
+   atpmap     intracellular ATP (mM), which sets IKatp
+
+ is a file with one value for each grid point, as text in the
+ layout of DiffusionCoefficient.txt or as a binary file made with
+ Utilities/diffusion2bin.c. Where there is no map the scaling is 1
+ and ATP is CELL_ATP.
+
+ Nodes with the same values form a class. The class of each node
+ is held in 2 bytes, and the values once for each class, in an
+ array for each parameter. Class 0 is the cell with no scaling and
+ normal ATP, which the kernels run with the parameters as
+ constants. The reaction step takes the nodes of each class
+ together (see group_nodes_2D()), so that each block of the SIMD
+ kernel holds a single class. Maps with a few regions of constant
+ value are best; every distinct value makes another class.
+
+***************************************************************/
+
+#define CELLMAP_HASH_SIZE (1 << 17)    /* power of 2, more than 2 * MAX_CELL_CLASSES */
+
+/***************************************************************
+
+ create_cellmap_2D
+
+ reads the maps in config and finds the class of each node, with
+ node geom[row][col] (0 or less for none) at each grid point
+
+***************************************************************/
+
+cellmap_2D *create_cellmap_2D( int **geom, int nrows, int ncols, int N )
+{
+  char *fname[NUM_CELLMAPS] = { config.gNaMap, config.gKsMap, config.gCaLMap, config.atpMap };
+  char *name[NUM_CELLMAPS] = { "GNAMAP", "GKSMAP", "GCALMAP", "ATPMAP" };
+  const double normal[NUM_CELLMAPS] = { 1.0, 1.0, 1.0, CELL_ATP };
+  const long RC = (long) nrows * ncols;
+  double *grid[NUM_CELLMAPS];
+  float key[NUM_CELLMAPS], *value;
+  int *table, numMaps = 0, row, col, n, i, c;
+  uint64_t h;
+  cellmap_2D *map;
+
+  map = (cellmap_2D *) malloc(sizeof(cellmap_2D));
+  if (!map) nrerror("allocation failure in create_cellmap_2D()");
+  map->N = N;
+  map->numClasses = 1;
+  map->cls = (unsigned short *) calloc((size_t) N + 1, sizeof(unsigned short));
+  value = (float *) malloc((size_t) MAX_CELL_CLASSES * NUM_CELLMAPS * sizeof(float));
+  if (!map->cls || !value) nrerror("allocation failure in create_cellmap_2D()");
+
+  for (i = 0; i < NUM_CELLMAPS; i++)
+    {
+    value[i] = (float) normal[i];
+    grid[i] = NULL;
+    if (fname[i][0])
+      {
+      grid[i] = fvector(1, RC);
+      read_grid_2D( fname[i], name[i], nrows, ncols, grid[i] );
+      numMaps++;
+      }
+    }
+
+  if (numMaps > 0)
+    {
+    /* classes are found with a hash table of their values, which */
+    /* holds the class + 1, or 0 for an empty slot */
+    table = (int *) calloc(CELLMAP_HASH_SIZE, sizeof(int));
+    if (!table) nrerror("allocation failure in create_cellmap_2D()");
+    h = hash_data_2D( value, sizeof(key) ) & (CELLMAP_HASH_SIZE - 1);
+    table[h] = 1;
+
+    for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+      {
+      n = geom[row][col];
+      if (n <= 0)
+        continue;
+      for (i = 0; i < NUM_CELLMAPS; i++)
+        {
+        key[i] = grid[i] ? (float) grid[i][(long) (row - 1) * ncols + col] : value[i];
+        if (key[i] < 0.0)
+          {
+          printf("%s row %d column %d: %g\n", name[i], row, col, key[i]);
+          nrerror("cell parameter maps cannot be negative");
+          }
+        }
+
+      h = hash_data_2D( key, sizeof(key) ) & (CELLMAP_HASH_SIZE - 1);
+      while ((table[h] > 0) && (memcmp(&value[(table[h] - 1) * NUM_CELLMAPS], key, sizeof(key)) != 0))
+        h = (h + 1) & (CELLMAP_HASH_SIZE - 1);
+      if (table[h] == 0)
+        {
+        if (map->numClasses == MAX_CELL_CLASSES)
+          nrerror("cell parameter maps have more than MAX_CELL_CLASSES combinations of values");
+        memcpy(&value[map->numClasses * NUM_CELLMAPS], key, sizeof(key));
+        table[h] = ++map->numClasses;
+        }
+      map->cls[n] = (unsigned short) (table[h] - 1);
+      }
+    free(table);
+    }
+
+  /* the values of each class, with class 0 exactly the normal cell */
+  map->gNa = fvector(0, map->numClasses - 1);
+  map->gKs = fvector(0, map->numClasses - 1);
+  map->gCaL = fvector(0, map->numClasses - 1);
+  map->atp = fvector(0, map->numClasses - 1);
+  for (c = 0; c < map->numClasses; c++)
+    {
+    map->gNa[c] = (c == 0) ? normal[0] : value[c * NUM_CELLMAPS];
+    map->gKs[c] = (c == 0) ? normal[1] : value[c * NUM_CELLMAPS + 1];
+    map->gCaL[c] = (c == 0) ? normal[2] : value[c * NUM_CELLMAPS + 2];
+    map->atp[c] = (c == 0) ? normal[3] : value[c * NUM_CELLMAPS + 3];
+    }
+
+  for (i = 0; i < NUM_CELLMAPS; i++)
+    if (grid[i])
+      free_fvector(grid[i], 1, RC);
+  free(value);
+
+  if (numMaps > 0)
+    printf("%d cell parameter maps, %d classes of cell\n", numMaps, map->numClasses);
+  return map;
+}
+
+/***************************************************************
+
+ free_cellmap_2D
+
+***************************************************************/
+
+void free_cellmap_2D( cellmap_2D *map )
+{
+  free_fvector(map->gNa, 0, map->numClasses - 1);
+  free_fvector(map->gKs, 0, map->numClasses - 1);
+  free_fvector(map->gCaL, 0, map->numClasses - 1);
+  free_fvector(map->atp, 0, map->numClasses - 1);
+  free(map->cls);
+  free(map);
+}
+
+/***************************************************************
+
+ group_nodes_2D
+
+ reorders list[1..num] so that the nodes of each class follow on
+ from each other, keeping their order within a class, and splits
+ it into blocks of up to blockSize nodes of a single class. Block
+ b is list[blockStart[b]] .. list[blockStart[b+1] - 1], and
+ blockStart needs room for num/blockSize + numClasses + 1 entries.
+ Returns the number of blocks. With a single class the list is
+ not changed and the blocks are those of blockSize nodes in turn.
+
+***************************************************************/
+
+int group_nodes_2D( cellmap_2D *map, int *list, int num, int *blockStart, int blockSize )
+{
+  int *first, *sorted, j, c, b, start;
+
+  if ((map->numClasses > 1) && (num > 0))
+    {
+    first = ivector(0, map->numClasses);
+    sorted = ivector(1, num);
+    for (c = 0; c <= map->numClasses; c++)
+      first[c] = 0;
+    for (j = 1; j <= num; j++)
+      first[map->cls[list[j]] + 1]++;
+    first[0] = 1;
+    for (c = 1; c <= map->numClasses; c++)
+      first[c] += first[c - 1];
+    for (j = 1; j <= num; j++)
+      sorted[first[map->cls[list[j]]]++] = list[j];
+    for (j = 1; j <= num; j++)
+      list[j] = sorted[j];
+    free_ivector(sorted, 1, num);
+    free_ivector(first, 0, map->numClasses);
+    }
+
+  b = 0;
+  j = 1;
+  while (j <= num)
+    {
+    c = map->cls[list[j]];
+    start = j;
+    while ((j <= num) && (j - start < blockSize) && (map->cls[list[j]] == c))
+      j++;
+    blockStart[b++] = start;
+    }
+  blockStart[b] = num + 1;
+
+  return b;
+}
@@ -0,0 +1,255 @@
+/***************************************************************
+
+ checkpoint_read.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+
+/***************************************************************
+
+  reads the solver state from binary file "checkpointXXXXXX.out"
+  written by checkpoint_write. Files from earlier versions, which
+  hold only time, t and u, can still be read, and the rest of
+  the state is then left as it was initialised. Version 2 files
+  have the same layout with a shorter header that does not hold
+  the size of the electrogram and snapshot files.
+
+***************************************************************/
+#include "TP06_OpSplit_2D.h"
+#include <stddef.h>
+#include <unistd.h>
+
+static char *unpack( char *buf, void *data, long bytes )
+{
+  memcpy(data, buf, bytes);
+  return buf + bytes;
+}
+
+/* bytes in the header of a checkpoint of this version, or 0 if */
+/* the version is not known */
+static long header_size( checkpoint_header *hdr )
+{
+  if (hdr->version == CHKPT_VERSION)
+    return sizeof(checkpoint_header);
+  if (hdr->version == 2)
+    return offsetof(checkpoint_header, egOffset);
+  return 0;
+}
+
+/* time, t and u node by node, as written by version 2.1 */
+static int checkpoint_read_old( checkpoint_2D *c, FILE *chkpt_file )
+{
+  int n, m, i = 0;
+  double U[NUM_STATES + 1];
+
+  rewind(chkpt_file);
+  i += fread( &c->time, sizeof(double),1,chkpt_file);
+  i += fread( &c->t, sizeof(int),1,chkpt_file);
+  for (n = 1; n <= c->N; n++)
+    {
+    i += fread( &U[1], sizeof(double), NUM_STATES, chkpt_file );
+    for (m = 1; m <= NUM_STATES; m++)
+      c->u->var[m][n] = U[m];
+    }
+  if (i != 2 + c->N * NUM_STATES) nrerror("checkpoint file is too short");
+
+  printf("old checkpoint format, only the model state u has been read\n");
+  c->stfcount = ceil(c->time);
+  c->t = c->t + 1;
+  c->egOffset = c->snapOffset = -1;
+  return (1);
+}
+
+int checkpoint_read( checkpoint_2D *c, int count )
+{
+  int m;
+  long N = c->N;
+  long dbytes = N * sizeof(double);
+  long ibytes = N * sizeof(int);
+  long size, hdrSize;
+  char fname[CONFIG_STRLEN + 16];
+  char *buf, *p;
+  checkpoint_header hdr;
+  FILE *chkpt_file;
+
+  sprintf( fname,"%s%06d.out",config.chkptRoot,count );
+  printf("opening checkpoint file %s\n",fname);
+  chkpt_file = fopen( fname, "rb" );
+  if (!chkpt_file) nrerror("cannot open checkpoint file");
+
+  if ((fread(&hdr, sizeof(hdr), 1, chkpt_file) != 1) || (memcmp(hdr.magic, CHKPT_MAGIC, 8) != 0))
+    {
+    m = checkpoint_read_old(c, chkpt_file);
+    fclose(chkpt_file);
+    return (m);
+    }
+
+  hdrSize = header_size(&hdr);
+  if (hdrSize == 0) nrerror("unknown checkpoint version");
+  if ((hdr.N != c->N) || (hdr.nrows != c->nrows) || (hdr.ncols != c->ncols)
+    || (hdr.numStates != NUM_STATES) || (hdr.numBeats != c->numBeats))
+    nrerror("checkpoint does not match the size of this simulation");
+  if (hdr.scar != c->scar)
+    nrerror("checkpoint was written with a different scar model");
+  if (hdr.dHash != c->dHash)
+    nrerror("checkpoint was written with a different DiffusionCoefficient.txt");
+
+  size = checkpoint_size(c) - sizeof(hdr) + hdrSize;
+  buf = (char *) malloc(size);
+  if (!buf) nrerror("allocation failure in checkpoint_read()");
+  rewind(chkpt_file);
+  if (fread(buf, 1, size, chkpt_file) != (size_t) size) nrerror("checkpoint file is too short");
+  fclose(chkpt_file);
+
+  p = buf + hdrSize;
+  for (m = 1; m <= NUM_STATES; m++)
+    p = unpack(p, &c->u->var[m][1], dbytes);
+  p = unpack(p, &c->new_Vm[1], dbytes);
+  p = unpack(p, &c->old_Vm[1], dbytes);
+  p = unpack(p, &c->dVdt[1], dbytes);
+  p = unpack(p, &c->dVreac[1], dbytes);
+  p = unpack(p, &c->upStrokeTime[1][1], dbytes * c->numBeats);
+  p = unpack(p, &c->downStrokeTime[1][1], dbytes * c->numBeats);
+  p = unpack(p, &c->beat[1], ibytes);
+  p = unpack(p, &c->frozen[1], ibytes);
+  free(buf);
+
+  c->t = hdr.t;
+  c->stfcount = hdr.stfcount;
+  c->time = hdr.time;
+  c->nextStim = hdr.nextStim;
+  c->egOffset = (hdrSize == sizeof(hdr)) ? hdr.egOffset : -1;
+  c->snapOffset = (hdrSize == sizeof(hdr)) ? hdr.snapOffset : -1;
+  if (hdrSize != sizeof(hdr))
+    printf("version %d checkpoint, output written after it is kept\n", hdr.version);
+
+  printf("read checkpoint at time = %g, t = %d\n",c->time,c->t);
+  return (1);
+}
+
+/***************************************************************
+
+  checkpoint_latest
+
+  returns the count of the last checkpoint written, from
+  CHKPTROOT.latest, or -1 if there is none
+
+***************************************************************/
+
+int checkpoint_latest( void )
+{
+  char fname[CONFIG_STRLEN + 16];
+  int count = -1;
+  FILE *fp;
+
+  sprintf( fname,"%s.latest",config.chkptRoot );
+  fp = fopen( fname, "r" );
+  if (fp)
+    {
+    if (fscanf(fp, "%d", &count) != 1)
+      count = -1;
+    fclose(fp);
+    }
+
+  return (count);
+}
+
+/***************************************************************
+
+  checkpoint_append
+
+  opens an output file of the run a checkpoint came from, to
+  carry on adding to it. Anything after the first offset bytes
+  was written after the checkpoint and is removed, and with
+  offset -1 (not known) the file is kept as it is. The file is
+  created if it does not exist.
+
+***************************************************************/
+
+FILE *checkpoint_append( char *fname, long offset )
+{
+  FILE *fp;
+
+  fp = fopen( fname, "r+" );
+  if (!fp)
+    return fopen( fname, "w" );
+
+  fseek(fp, 0, SEEK_END);
+  if ((offset >= 0) && (offset < ftell(fp)))
+    {
+    if (ftruncate(fileno(fp), offset) != 0)
+      nrerror("cannot remove output written after the checkpoint");
+    fseek(fp, offset, SEEK_SET);
+    }
+
+  return fp;
+}
+
+/***************************************************************
+
+  checkpoint_seed_read
+
+  reads the state of one node of a checkpoint into U, so that it
+  can be copied to every node of a new simulation. The checkpoint
+  can come from any geometry and any DiffusionCoefficient.txt,
+  for example a single cell paced to steady state with -makeseed,
+  or homogeneous tissue at rest.
+
+***************************************************************/
+
+int checkpoint_seed_read( char *fname, int node, double *U )
+{
+  int m;
+  long hdrSize;
+  checkpoint_header hdr;
+  FILE *seed_file;
+
+  printf("opening seed file %s\n",fname);
+  seed_file = fopen( fname, "rb" );
+  if (!seed_file) nrerror("cannot open seed file");
+
+  if ((fread(&hdr, sizeof(hdr), 1, seed_file) != 1) || (memcmp(hdr.magic, CHKPT_MAGIC, 8) != 0))
+    nrerror("seed file is not a checkpoint");
+  hdrSize = header_size(&hdr);
+  if ((hdrSize == 0) || (hdr.numStates != NUM_STATES))
+    nrerror("seed file is from a different version");
+  if ((node < 1) || (node > hdr.N))
+    nrerror("seed node is not in the seed file");
+
+  /* state variable m of node n is at var[m][n] */
+  for (m = 1; m <= NUM_STATES; m++)
+    {
+    if ((fseek(seed_file, hdrSize + (((long) m - 1) * hdr.N + node - 1) * sizeof(double), SEEK_SET) != 0)
+      || (fread(&U[m], sizeof(double), 1, seed_file) != 1))
+      nrerror("seed file is too short");
+    }
+  fclose(seed_file);
+
+  printf("seeding from node %d of %d at time = %g, Vm = %g\n",node,hdr.N,hdr.time,U[1]);
+  return (1);
+}
@@ -0,0 +1,301 @@
+/***************************************************************
+
+ checkpoint_write.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/***************************************************************
+
+  Writes the solver state to binary file "checkpointXXXXXX.out"
+
+  The file is a checkpoint_header followed by
+
+    u->var[m][1..N]          m = 1..NUM_STATES
+    new_Vm, old_Vm, dVdt, dVreac
+    upStrokeTime, downStrokeTime    N x numBeats, row by row
+    beat, frozen                    int
+
+  which is everything the main loop needs to carry on from where
+  it left off and give the same results as a run that was not
+  stopped. The header also holds the number of bytes written to
+  the electrogram and snapshot files, so that a restart can carry
+  on adding to them from the same point. The state is packed into
+  one buffer and written with a single fwrite.
+
+***************************************************************/
+#include "TP06_OpSplit_2D.h"
+#include <unistd.h>
+
+/***************************************************************
+
+  hash_file_2D
+
+  64 bit FNV-1a hash of a file, used to check that a checkpoint
+  is read back with the same DiffusionCoefficient.txt, and of the
+  diffusion coefficients when the scar is made in memory
+
+***************************************************************/
+
+static uint64_t fnv1a( uint64_t hash, unsigned char *buf, size_t n )
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+    hash ^= buf[i];
+    hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+uint64_t hash_file_2D( char *fname )
+{
+  uint64_t hash = 14695981039346656037ULL;
+  unsigned char buf[65536];
+  size_t n;
+  FILE *fp;
+
+  fp = fopen( fname, "rb" );
+  if (!fp) return 0;
+
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    hash = fnv1a(hash, buf, n);
+
+  fclose(fp);
+  return hash;
+}
+
+uint64_t hash_data_2D( void *data, long size )
+{
+  return fnv1a(14695981039346656037ULL, (unsigned char *) data, size);
+}
+
+/***************************************************************
+
+  checkpoint_size and checkpoint_pack
+
+  size of the checkpoint in bytes, and copies the state into buf
+
+***************************************************************/
+
+long checkpoint_size( checkpoint_2D *c )
+{
+  long N = c->N;
+
+  return sizeof(checkpoint_header)
+    + (NUM_STATES + 4) * N * sizeof(double)
+    + 2 * N * c->numBeats * sizeof(double)
+    + 2 * N * sizeof(int);
+}
+
+static char *pack( char *buf, void *data, long bytes )
+{
+  memcpy(buf, data, bytes);
+  return buf + bytes;
+}
+
+void checkpoint_pack( checkpoint_2D *c, char *buf )
+{
+  int m;
+  long N = c->N;
+  long dbytes = N * sizeof(double);
+  long ibytes = N * sizeof(int);
+  checkpoint_header hdr;
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, CHKPT_MAGIC, 8);
+  hdr.version = CHKPT_VERSION;
+  hdr.N = c->N;
+  hdr.nrows = c->nrows;
+  hdr.ncols = c->ncols;
+  hdr.numStates = NUM_STATES;
+  hdr.numBeats = c->numBeats;
+  hdr.scar = c->scar;
+  hdr.t = c->t;
+  hdr.stfcount = c->stfcount;
+  hdr.time = c->time;
+  hdr.nextStim = c->nextStim;
+  hdr.dHash = c->dHash;
+  hdr.egOffset = c->egOffset;
+  hdr.snapOffset = c->snapOffset;
+
+  buf = pack(buf, &hdr, sizeof(hdr));
+  for (m = 1; m <= NUM_STATES; m++)
+    buf = pack(buf, &c->u->var[m][1], dbytes);
+  buf = pack(buf, &c->new_Vm[1], dbytes);
+  buf = pack(buf, &c->old_Vm[1], dbytes);
+  buf = pack(buf, &c->dVdt[1], dbytes);
+  buf = pack(buf, &c->dVreac[1], dbytes);
+  buf = pack(buf, &c->upStrokeTime[1][1], dbytes * c->numBeats);
+  buf = pack(buf, &c->downStrokeTime[1][1], dbytes * c->numBeats);
+  buf = pack(buf, &c->beat[1], ibytes);
+  buf = pack(buf, &c->frozen[1], ibytes);
+}
+
+/***************************************************************
+
+  checkpoint_flush
+
+  writes a packed checkpoint to a temporary file and renames it
+  to "checkpointXXXXXX.out" once it is safely on disk, so that a
+  run stopped part way through writing never leaves a damaged
+  checkpoint. CHKPTROOT.latest is then updated to hold count.
+
+***************************************************************/
+
+int checkpoint_flush( char *buf, long size, int count )
+{
+  char fname[CONFIG_STRLEN + 16], tmpname[CONFIG_STRLEN + 32];
+  FILE *chkpt_file;
+
+  sprintf( fname,"%s%06d.out",config.chkptRoot,count );
+  sprintf( tmpname,"%s.tmp",fname );
+
+  chkpt_file = fopen( tmpname, "wb" );
+  if (!chkpt_file)
+    {
+    perror("cannot open checkpoint file");
+    return (0);
+    }
+  if ((fwrite(buf, 1, size, chkpt_file) != (size_t) size) || (fflush(chkpt_file) != 0)
+    || (fsync(fileno(chkpt_file)) != 0))
+    {
+    perror("error writing checkpoint");
+    fclose(chkpt_file);
+    remove(tmpname);
+    return (0);
+    }
+  fclose(chkpt_file);
+  if (rename(tmpname, fname) != 0)
+    {
+    perror("cannot rename checkpoint file");
+    return (0);
+    }
+
+  sprintf( tmpname,"%s.latest.tmp",config.chkptRoot );
+  sprintf( fname,"%s.latest",config.chkptRoot );
+  chkpt_file = fopen( tmpname, "w" );
+  if (chkpt_file)
+    {
+    fprintf(chkpt_file, "%d\n", count);
+    fclose(chkpt_file);
+    rename(tmpname, fname);
+    }
+
+  return (1);
+}
+
+/***************************************************************
+
+  checkpoint_write
+
+***************************************************************/
+
+int checkpoint_write( checkpoint_2D *c, int count )
+{
+  char *buf;
+  long size = checkpoint_size(c);
+  int ok;
+
+  printf("writing checkpoint %s%06d.out\n",config.chkptRoot,count);
+
+  buf = (char *) malloc(size);
+  if (!buf) nrerror("allocation failure in checkpoint_write()");
+  checkpoint_pack(c, buf);
+  ok = checkpoint_flush(buf, size, count);
+  free(buf);
+
+  if (ok)
+    printf("written checkpoint at time = %g, t = %d, %ld bytes\n",c->time,c->t,size);
+  return (ok);
+}
+
+/***************************************************************
+
+  checkpoint_seed_write
+
+  writes the state U of a single cell as a checkpoint with N = 1,
+  which can be used with -seed to start a simulation on any
+  geometry from that state
+
+***************************************************************/
+
+int checkpoint_seed_write( char *fname, double *U, double time )
+{
+  int m;
+  long size;
+  char *buf;
+  checkpoint_2D c;
+  FILE *seed_file;
+
+  /* a one node simulation with no upstroke times */
+  memset(&c, 0, sizeof(c));
+  c.N = c.nrows = c.ncols = 1;
+  c.numBeats = 0;
+  c.time = time;
+  c.egOffset = c.snapOffset = -1;
+  c.u = create_state_2D( 1 );
+  for (m = 1; m <= NUM_STATES; m++)
+    c.u->var[m][1] = U[m];
+  c.new_Vm = fvector(1, 1);
+  c.old_Vm = fvector(1, 1);
+  c.dVdt = fvector(1, 1);
+  c.dVreac = fvector(1, 1);
+  c.upStrokeTime = fmatrix(1, 1, 1, 1);
+  c.downStrokeTime = fmatrix(1, 1, 1, 1);
+  c.beat = ivector(1, 1);
+  c.frozen = ivector(1, 1);
+  c.new_Vm[1] = c.old_Vm[1] = U[1];
+  c.dVdt[1] = c.dVreac[1] = 0.0;
+  c.beat[1] = 1;
+  c.frozen[1] = 0;
+
+  size = checkpoint_size(&c);
+  buf = (char *) malloc(size);
+  if (!buf) nrerror("allocation failure in checkpoint_seed_write()");
+  checkpoint_pack(&c, buf);
+
+  seed_file = fopen( fname, "wb" );
+  if (!seed_file) nrerror("cannot open seed file");
+  if (fwrite(buf, 1, size, seed_file) != (size_t) size) nrerror("error writing seed file");
+  fclose(seed_file);
+  free(buf);
+
+  free_state_2D( c.u );
+  free_fvector(c.new_Vm, 1, 1);
+  free_fvector(c.old_Vm, 1, 1);
+  free_fvector(c.dVdt, 1, 1);
+  free_fvector(c.dVreac, 1, 1);
+  free_fmatrix(c.upStrokeTime, 1, 1, 1, 1);
+  free_fmatrix(c.downStrokeTime, 1, 1, 1, 1);
+  free_ivector(c.beat, 1, 1);
+  free_ivector(c.frozen, 1, 1);
+
+  printf("written seed file %s\n", fname);
+  return (1);
+}
@@ -0,0 +1,465 @@
+/***************************************************************
+
+ config_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+#include <stddef.h>
+
+/***************************************************************
+
+ Run time configuration. Each setting starts with the value
+ defined in the header file, and can be changed by a config file
+ given with -config <file>, and by -<name> <value> on the command
+ line, in the order they appear. A config file has one setting
+ per line, as
+
+   name value      or      name = value
+
+ and anything after # is ignored. The settings used are written
+ to OUTPUTFILEROOT config.txt at the start of each run, in the
+ same format, so that the run can be repeated.
+
+***************************************************************/
+
+config_2D config;
+
+#define CONFIG_INT      0
+#define CONFIG_DOUBLE   1
+#define CONFIG_STRING   2
+
+typedef struct
+{
+  char *name;
+  int type;
+  size_t offset;
+} config_entry;
+
+static const config_entry entries[] =
+{
+  { "rows",           CONFIG_INT,    offsetof(config_2D, nrows) },
+  { "cols",           CONFIG_INT,    offsetof(config_2D, ncols) },
+  { "iterations",     CONFIG_INT,    offsetof(config_2D, numIterations) },
+  { "dt",             CONFIG_DOUBLE, offsetof(config_2D, dt) },
+  { "dx",             CONFIG_DOUBLE, offsetof(config_2D, dx) },
+  { "bcl",            CONFIG_DOUBLE, offsetof(config_2D, bcl) },
+  { "s1beats",        CONFIG_INT,    offsetof(config_2D, numS1Beats) },
+  { "s2beats",        CONFIG_INT,    offsetof(config_2D, numS2Beats) },
+  { "s2start",        CONFIG_DOUBLE, offsetof(config_2D, s2Start) },
+  { "s2end",          CONFIG_DOUBLE, offsetof(config_2D, s2End) },
+  { "stimrow",        CONFIG_INT,    offsetof(config_2D, stimRow) },
+  { "stimcol",        CONFIG_INT,    offsetof(config_2D, stimCol) },
+  { "stimradius",     CONFIG_INT,    offsetof(config_2D, stimRadius) },
+  { "eginterval",     CONFIG_DOUBLE, offsetof(config_2D, egInterval) },
+  { "snapinterval",   CONFIG_DOUBLE, offsetof(config_2D, snapInterval) },
+  { "diffusionfile",  CONFIG_STRING, offsetof(config_2D, diffusionFile) },
+  { "outputroot",     CONFIG_STRING, offsetof(config_2D, outputRoot) },
+  { "stfroot",        CONFIG_STRING, offsetof(config_2D, stfRoot) },
+  { "snapshotfile",   CONFIG_STRING, offsetof(config_2D, snapshotFile) },
+  { "checkpointroot", CONFIG_STRING, offsetof(config_2D, chkptRoot) },
+  { "chkptread",      CONFIG_INT,    offsetof(config_2D, chkptRead) },
+  { "chkptreadtime",  CONFIG_INT,    offsetof(config_2D, chkptReadTime) },
+  { "chkptwrite",     CONFIG_INT,    offsetof(config_2D, chkptWrite) },
+  { "chkptwritetime", CONFIG_INT,    offsetof(config_2D, chkptWriteTime) },
+  { "checkpoint",     CONFIG_DOUBLE, offsetof(config_2D, chkptInterval) },
+  { "keep",           CONFIG_INT,    offsetof(config_2D, keep) },
+  { "threads",        CONFIG_INT,    offsetof(config_2D, threads) },
+  { "gate",           CONFIG_DOUBLE, offsetof(config_2D, gate) },
+  { "seed",           CONFIG_STRING, offsetof(config_2D, seedFile) },
+  { "seednode",       CONFIG_INT,    offsetof(config_2D, seedNode) },
+  { "seedout",        CONFIG_STRING, offsetof(config_2D, seedOut) },
+  { "makeseed",       CONFIG_INT,    offsetof(config_2D, makeSeed) },
+  { "ensemble",       CONFIG_STRING, offsetof(config_2D, ensemble) },
+  { "jobs",           CONFIG_INT,    offsetof(config_2D, jobs) },
+  { "batch",          CONFIG_INT,    offsetof(config_2D, batch) },
+  { "grf",            CONFIG_DOUBLE, offsetof(config_2D, grf) },
+  { "grfseed",        CONFIG_INT,    offsetof(config_2D, grfSeed) },
+  { "grfremove",      CONFIG_INT,    offsetof(config_2D, grfRemove) },
+  { "grfout",         CONFIG_STRING, offsetof(config_2D, grfOut) },
+  { "gnamap",         CONFIG_STRING, offsetof(config_2D, gNaMap) },
+  { "gksmap",         CONFIG_STRING, offsetof(config_2D, gKsMap) },
+  { "gcalmap",        CONFIG_STRING, offsetof(config_2D, gCaLMap) },
+  { "atpmap",         CONFIG_STRING, offsetof(config_2D, atpMap) }
+};
+
+#define NUM_ENTRIES ((int) (sizeof(entries) / sizeof(entries[0])))
+
+/* lower limits of the numeric settings that the main loop depends */
+/* on, and whether the value must be greater than (1) or at least */
+/* (0) the limit */
+typedef struct
+{
+  char *name;
+  double min;
+  int strict;
+} config_limit;
+
+static const config_limit limits[] =
+{
+  { "rows",           1.0, 0 },
+  { "cols",           1.0, 0 },
+  { "dt",             0.0, 1 },
+  { "bcl",            0.0, 1 },
+  { "s1beats",        1.0, 0 },
+  { "s2beats",        0.0, 0 },
+  { "eginterval",     0.0, 1 },
+  { "snapinterval",   0.0, 1 },
+  { "keep",           1.0, 0 }
+};
+
+#define NUM_LIMITS ((int) (sizeof(limits) / sizeof(limits[0])))
+
+static const char *scarNames[] = { "continuous", "smooth", "threshold" };
+static const char *kernelNames[] = { "scalar", "simd" };
+static const char *snapshotNames[] = { "stf", "float", "int16" };
+
+static int set_probes( config_2D *c, const char *value );
+
+/***************************************************************
+
+ default_config_2D
+
+***************************************************************/
+
+void default_config_2D( config_2D *c )
+{
+  memset(c, 0, sizeof(config_2D));
+
+  c->nrows = ROWS;
+  c->ncols = COLUMNS;
+  c->numIterations = NUM_ITERATIONS;
+  c->scar = SCAR_MODEL;
+  c->dt = DT;
+  c->dx = DX;
+  c->bcl = S1BCL;
+  c->numS1Beats = NUMS1BEATS;
+  c->numS2Beats = NUMS2BEATS;
+  c->s2Start = S2START;
+  c->s2End = S2END;
+  c->stimRow = STIMROW;
+  c->stimCol = STIMCOL;
+  c->stimRadius = STIMRADIUS;
+  c->egInterval = EGINTERVAL;
+  c->snapInterval = SNAPINTERVAL;
+  set_probes(c, PROBES);
+  strcpy(c->diffusionFile, DIFFUSIONFILE);
+  strcpy(c->outputRoot, OUTPUTFILEROOT);
+  strcpy(c->stfRoot, STFFILEROOT);
+  strcpy(c->snapshotFile, SNAPSHOTFILE);
+  strcpy(c->chkptRoot, CHKPTROOT);
+  c->chkptRead = CHKPT_READ;
+  c->chkptReadTime = CHKPT_READ_TIME;
+  c->chkptWrite = CHKPT_WRITE;
+  c->chkptWriteTime = CHKPT_WRITE_TIME;
+  c->chkptInterval = 0.0;
+  c->keep = CHKPT_KEEP;
+  c->restart = -1;
+  c->threads = 0;
+  c->kernel = KERNEL_SCALAR;
+  c->parameterSet = PARAMETER_SET;
+  c->gate = 0.0;
+  c->snapshots = SNAPSHOT_INT16;
+  c->seedFile[0] = '\0';
+  c->seedNode = 1;
+  strcpy(c->seedOut, SEEDFILE);
+  c->makeSeed = 0;
+  c->ensemble[0] = '\0';
+  c->jobs = 1;
+  c->batch = 1;
+  c->grf = GRF_LENGTH;
+  c->grfSeed = GRF_SEED;
+  c->grfRemove = 0;
+  c->grfOut[0] = '\0';
+  c->gNaMap[0] = '\0';
+  c->gKsMap[0] = '\0';
+  c->gCaLMap[0] = '\0';
+  c->atpMap[0] = '\0';
+}
+
+/***************************************************************
+
+ set_config_2D
+
+ sets the named setting from the text value. Returns 1 if it
+ was set, 0 if the name or the value is not recognised, or the
+ value is below the limit for the setting (see limits[]), in
+ which case the setting is not changed.
+
+***************************************************************/
+
+static int lookup_name( const char **names, int num, char *value )
+{
+  int i;
+
+  for (i = 0; i < num; i++)
+    if (strcmp(value, names[i]) == 0)
+      return i;
+  return -1;
+}
+
+/* electrogram probes, as row:col,row:col,... */
+static int set_probes( config_2D *c, const char *value )
+{
+  int num = 0, row[MAX_PROBES], col[MAX_PROBES], len;
+
+  while (*value)
+    {
+    if ((num == MAX_PROBES) || (sscanf(value, "%d:%d%n", &row[num], &col[num], &len) != 2)
+      || (row[num] < 1) || (col[num] < 1))
+      return 0;
+    num++;
+    value += len;
+    if (*value == ',')
+      value++;
+    else if (*value)
+      return 0;
+    }
+  if (num == 0) return 0;
+
+  c->numProbes = num;
+  memcpy(c->probeRow, row, num * sizeof(int));
+  memcpy(c->probeCol, col, num * sizeof(int));
+  return 1;
+}
+
+/* 1 if x is within the limit for the named setting */
+static int within_limit( char *name, double x )
+{
+  int i;
+
+  for (i = 0; i < NUM_LIMITS; i++)
+    if (strcmp(name, limits[i].name) == 0)
+      return limits[i].strict ? (x > limits[i].min) : (x >= limits[i].min);
+  return 1;
+}
+
+int set_config_2D( config_2D *c, char *name, char *value )
+{
+  int i, n;
+  double x;
+  char *end;
+  void *p;
+
+  /* settings that are names rather than numbers */
+  if (strcmp(name, "scar") == 0)
+    {
+    i = lookup_name(scarNames, 3, value);
+    if (i < 0) return 0;
+    c->scar = i;
+    return 1;
+    }
+  if (strcmp(name, "kernel") == 0)
+    {
+    i = lookup_name(kernelNames, 2, value);
+    if (i < 0) return 0;
+    c->kernel = i;
+    return 1;
+    }
+  if (strcmp(name, "par") == 0)
+    {
+    i = strtol(value, &end, 10);
+    if ((end == value) || (*end != '\0') || (i < 1) || (i > NUM_PARAMETER_SETS)) return 0;
+    c->parameterSet = i;
+    return 1;
+    }
+  if (strcmp(name, "snapshots") == 0)
+    {
+    i = lookup_name(snapshotNames, 3, value);
+    if (i < 0) return 0;
+    c->snapshots = i;
+    return 1;
+    }
+  if (strcmp(name, "probes") == 0)
+    return set_probes(c, value);
+  if (strcmp(name, "restart") == 0)
+    {
+    if (strcmp(value, "latest") == 0)
+      c->restart = CHKPT_LATEST;
+    else
+      {
+      c->restart = strtol(value, &end, 10);
+      if ((end == value) || (*end != '\0')) return 0;
+      }
+    return 1;
+    }
+
+  for (i = 0; i < NUM_ENTRIES; i++)
+    {
+    if (strcmp(name, entries[i].name) != 0)
+      continue;
+
+    p = (char *) c + entries[i].offset;
+    switch (entries[i].type)
+      {
+      case CONFIG_INT:
+        n = strtol(value, &end, 10);
+        if ((end == value) || (*end != '\0') || !within_limit(name, n)) return 0;
+        *(int *) p = n;
+        return 1;
+      case CONFIG_DOUBLE:
+        x = strtod(value, &end);
+        if ((end == value) || (*end != '\0') || !within_limit(name, x)) return 0;
+        *(double *) p = x;
+        return 1;
+      default:
+        if (strlen(value) >= CONFIG_STRLEN) return 0;
+        strcpy((char *) p, value);
+        return 1;
+      }
+    }
+
+  return 0;
+}
+
+/***************************************************************
+
+ read_config_2D
+
+ reads settings from a config file, see above for the format
+
+***************************************************************/
+
+int read_config_2D( config_2D *c, char *fname )
+{
+  char line[2 * CONFIG_STRLEN], name[64], value[CONFIG_STRLEN];
+  char *p;
+  int lineNum = 0, num = 0;
+  FILE *fp;
+
+  fp = fopen( fname, "r" );
+  if (!fp) nrerror("cannot open config file");
+
+  while (fgets(line, sizeof(line), fp))
+    {
+    lineNum++;
+    if ((p = strchr(line, '#')) != NULL) *p = '\0';
+    for (p = line; *p; p++)
+      if (*p == '=') *p = ' ';
+
+    switch (sscanf(line, "%63s %255s", name, value))
+      {
+      case EOF:
+      case 0:
+        break;
+      case 1:
+        printf("%s line %d: no value for %s\n", fname, lineNum, name);
+        nrerror("error in config file");
+        break;
+      default:
+        if (!set_config_2D(c, name, value))
+          {
+          printf("%s line %d: cannot set %s to %s\n", fname, lineNum, name, value);
+          nrerror("error in config file");
+          }
+        num++;
+      }
+    }
+  fclose(fp);
+
+  printf("read %d settings from %s\n", num, fname);
+  return (num);
+}
+
+/***************************************************************
+
+ parse_config_args_2D
+
+ applies -config <file> and -<name> <value> from the command
+ line in order. Returns the number of options that were not
+ recognised or had a bad value.
+
+***************************************************************/
+
+int parse_config_args_2D( config_2D *c, int argc, char **argv )
+{
+  int i, bad = 0;
+
+  for (i = 1; i < argc; i++)
+    {
+    if ((argv[i][0] != '-') || (i + 1 >= argc))
+      {
+      printf("option %s has no value\n", argv[i]);
+      bad++;
+      }
+    else if (strcmp(argv[i], "-config") == 0)
+      read_config_2D(c, argv[++i]);
+    else if (set_config_2D(c, argv[i] + 1, argv[i + 1]))
+      i++;
+    else
+      {
+      printf("unknown option or bad value %s %s\n", argv[i], argv[i + 1]);
+      bad++;
+      i++;
+      }
+    }
+
+  return (bad);
+}
+
+/***************************************************************
+
+ write_config_2D
+
+ writes every setting in the config file format
+
+***************************************************************/
+
+void write_config_2D( config_2D *c, FILE *fp )
+{
+  int i;
+  void *p;
+
+  for (i = 0; i < NUM_ENTRIES; i++)
+    {
+    p = (char *) c + entries[i].offset;
+    switch (entries[i].type)
+      {
+      case CONFIG_INT:
+        fprintf(fp, "%-15s %d\n", entries[i].name, *(int *) p);
+        break;
+      case CONFIG_DOUBLE:
+        fprintf(fp, "%-15s %.15g\n", entries[i].name, *(double *) p);
+        break;
+      default:
+        if (*(char *) p)
+          fprintf(fp, "%-15s %s\n", entries[i].name, (char *) p);
+      }
+    }
+  fprintf(fp, "%-15s %s\n", "scar", scarNames[c->scar]);
+  fprintf(fp, "%-15s %s\n", "kernel", kernelNames[c->kernel]);
+  fprintf(fp, "%-15s %d\n", "par", c->parameterSet);
+  fprintf(fp, "%-15s %s\n", "snapshots", snapshotNames[c->snapshots]);
+  fprintf(fp, "%-15s ", "probes");
+  for (i = 0; i < c->numProbes; i++)
+    fprintf(fp, "%d:%d%s", c->probeRow[i], c->probeCol[i], (i < c->numProbes - 1) ? "," : "\n");
+  if (c->restart == CHKPT_LATEST)
+    fprintf(fp, "%-15s latest\n", "restart");
+  else if (c->restart >= 0)
+    fprintf(fp, "%-15s %d\n", "restart", c->restart);
+}
@@ -275,3 +275,162 @@ int create_TP06_lookup_OpSplit_2D( double **lookup )
 
   return (1); // success
 }
+
+/***************************************************************
+
+ create_volt_table
+
+ The voltage table holds the terms of the currents that depend on
+ Vm alone, at LOOKUP_VPOINTS points LOOKUP_VSTEP apart from
+ LOOKUP_VLOW, with the parameters of calculate_TP06_current_OpSplit()
+
+   0, 1  ICaL = G d f f2 fCass (term[0] CaSS - term[1])
+   2     rec_ipK
+   3     rec_iNaK
+   4     naca2
+   5, 6  exp(nn Vm F/RT) and exp((nn-1) Vm F/RT) of INaCa
+
+ Record i holds the terms at point i in record[t], followed by
+ their change to point i+1 in record[NUM_VTERMS + t], so that they
+ can be interpolated from one record (see lookup_volt_2D()).
+
+ The GHK factor of ICaL is 0/0 at Vm = 15 mV. With
+ x = 2 (Vm - 15) F/RT and g(x) = x/(exp(x) - 1), which goes to 1 as
+ x goes to 0,
+
+   term[0] = F/2 (g(x) + x),   term[1] = 2 F Cao g(x)
+
+ and g(x) is found with expm1(), so the table has no singularity.
+
+***************************************************************/
+
+static void create_volt_table( lookup_2D *lk )
+{
+  const double Rgas = 8314.472;      /* Universal Gas Constant (J/kmol*K) */
+  const double Frdy = 96485.3415;    /* Faraday's Constant (C/mol) */
+  const double Temp = 310.0;         /* Temperature (K) 37C */
+  const double RTonF = (Rgas * Temp) / Frdy;
+  const double Cao = 2.0;
+  const double ksat = 0.1;
+  const double nn = 0.35;
+  double **term;
+  double Vm, VmoRTonF, x, g;
+  lookup_t *rec;
+  void *p = NULL;
+  size_t size;
+  int i, t;
+
+  term = fmatrix(0, LOOKUP_VPOINTS - 1, 0, NUM_VTERMS - 1);
+  for (i = 0; i < LOOKUP_VPOINTS; i++)
+    {
+    Vm = LOOKUP_VLOW + i * LOOKUP_VSTEP;
+    VmoRTonF = Vm/RTonF;
+
+    x = 2.0*(Vm - 15.0)/RTonF;
+    g = (x == 0.0) ? 1.0 : x/expm1(x);
+    term[i][0] = 0.5*Frdy*(g + x);
+    term[i][1] = 2.0*Frdy*Cao*g;
+
+    term[i][2] = 1.0/(1.0+exp((25.0-Vm)/5.98));
+    term[i][3] = (1.0/(1.0+0.1245*exp(-0.1*VmoRTonF)+0.0353*exp(-VmoRTonF)));
+    term[i][4] = (1.0/(1.0+ksat*exp((nn-1.0)*VmoRTonF)));
+    term[i][5] = exp(nn*VmoRTonF);
+    term[i][6] = exp((nn-1.0)*VmoRTonF);
+    }
+
+  size = (size_t) LOOKUP_VPOINTS * LOOKUP_VRECORD * sizeof(lookup_t);
+  if (posix_memalign(&p, ALIGNMENT, size) != 0)
+    nrerror("allocation failure in create_lookup_2D()");
+  lk->volt = (lookup_t *) p;
+  memset(lk->volt, 0, size);
+
+  for (i = 0; i < LOOKUP_VPOINTS; i++)
+    {
+    rec = &lk->volt[(long) i * LOOKUP_VRECORD];
+    for (t = 0; t < NUM_VTERMS; t++)
+      {
+      rec[t] = (lookup_t) term[i][t];
+      if (i < LOOKUP_VPOINTS - 1)
+        rec[NUM_VTERMS + t] = (lookup_t) (term[i+1][t] - term[i][t]);
+      }
+    }
+  free_fmatrix(term, 0, LOOKUP_VPOINTS - 1, 0, NUM_VTERMS - 1);
+}
+
+/***************************************************************
+
+ create_lookup_2D
+
+ The adaptive time step divides dt into kmax sub-steps of dt/kmax,
+ with kmax from 1 to ceil(dt/0.01) (see main()), so exp(-dt/tau)
+ of each gate can be tabulated for every sub-step. The kernels use
+ the table at whole mV (floor(Vm)), so the gate table has a record
+ for each sub-step k and 1 mV bin from LOOKUP_VMIN, holding
+
+   record[2*g]      inf of gate g
+   record[2*g + 1]  exp(-(dt/k)/tau) of gate g
+
+ for the gates m, h, j, d, f, f2, xr1, xr2, xs, r, s (epi), with
+ tau_f as adjusted for Vm >= 0 in parameter set par. Records are padded to whole cache
+ lines and the bins of each sub-step follow each other, so a node
+ reads LOOKUP_RECORD entries from one place rather than a value
+ from each of 22 rows, and the records of neighbouring bins are
+ adjacent. The inf and tau rows are kept in var[][], and the terms
+ that depend on Vm alone in the voltage table (create_volt_table()).
+
+***************************************************************/
+
+lookup_2D *create_lookup_2D( double dt, int par )
+{
+  /* rows of var[][] for inf and tau of the gates in the gate table */
+  const int infRow[NUM_EXP_GATES] = { 6, 2, 4, 8, 10, 12, 14, 16, 18, 19, 21 };
+  const int tauRow[NUM_EXP_GATES] = { 5, 1, 3, 7, 9, 11, 13, 15, 17, 20, 22 };
+  const int gate_f = 4;
+  lookup_2D *lk;
+  lookup_t *rec;
+  void *p = NULL;
+  size_t size;
+  int g, k, bin, Vindex;
+  double tau;
+
+  lk = (lookup_2D *) malloc(sizeof(lookup_2D));
+  if (!lk) nrerror("allocation failure in create_lookup_2D()");
+  lk->var = fmatrix(0, NUM_LOOKUP, 0, VOLTAGE_STEPS);
+  create_TP06_lookup_OpSplit_2D( lk->var );
+
+  lk->dt = dt;
+  lk->par = par;
+  lk->numK = (int) ceil(dt/0.01);
+  size = (size_t) lk->numK * LOOKUP_BINS * LOOKUP_RECORD * sizeof(lookup_t);
+  if (posix_memalign(&p, ALIGNMENT, size) != 0)
+    nrerror("allocation failure in create_lookup_2D()");
+  lk->gate = (lookup_t *) p;
+  memset(lk->gate, 0, size);
+
+  for (k = 1; k <= lk->numK; k++)
+    for (bin = 0; bin < LOOKUP_BINS; bin++)
+      {
+      Vindex = (bin + LOOKUP_VMIN) * GAIN + VMOFFSET;
+      rec = &lk->gate[((long) (k - 1) * LOOKUP_BINS + bin) * LOOKUP_RECORD];
+      for (g = 0; g < NUM_EXP_GATES; g++)
+        {
+        tau = lk->var[tauRow[g]][Vindex];
+        if ((g == gate_f) && (bin + LOOKUP_VMIN >= 0))
+          tau *= tp06_parameter_set[par - 1].tau_f_multiplier;
+        rec[2*g] = (lookup_t) lk->var[infRow[g]][Vindex];
+        rec[2*g + 1] = (lookup_t) exp( -(dt / (double) k) / tau );
+        }
+      }
+
+  create_volt_table( lk );
+
+  return lk;
+}
+
+void free_lookup_2D( lookup_2D *lk )
+{
+  free_fmatrix(lk->var, 0, NUM_LOOKUP, 0, VOLTAGE_STEPS);
+  free(lk->gate);
+  free(lk->volt);
+  free(lk);
+}
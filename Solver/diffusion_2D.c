@@ -0,0 +1,320 @@
+
+/***************************************************************
+
+ diffusion_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ create_stencil_2D
+
+ sets up the diffusion operator on the structured lattice. Each
+ lattice array has a ring of ghost sites. D does not change once
+ the geometry has been read, so the diffusion term at each node is
+ reduced here to a weighted sum of Vm at the node and its four
+ nearest neighbours
+
+   w0*V + w2*Vnn2 + w4*Vnn4 + w6*Vnn6 + w8*Vnn8
+
+ with DX, D and the no-flux boundary folded into the weights.
+ nneighb[n][1..4] holds the neighbours nn2, nn4, nn6 and nn8.
+ Where there is no neighbouring node its Vm is taken to be Vm
+ here, so its weight is moved onto w0.
+
+ The scar models differ only in the weights. With SCAR_CONTINUOUS
+ and SCAR_SMOOTH D varies in space and the gradient of D is
+ included, and with SCAR_THRESHOLD D is the same everywhere and
+ there is no gradient term. The sweep over the lattice is then
+ the same for all three.
+
+***************************************************************/
+
+stencil_2D *create_stencil_2D( int **geom, int nrows, int ncols, int **nneighb, double *D, int N, int scar )
+{
+  int row, col, n, s;
+  long size;
+  double Dnn2, Dnn4, Dnn6, Dnn8;
+  double dDdx, dDdy, c2, c4, c6, c8;
+  double dx2 = config.dx * config.dx;
+  double twodx = config.dx * 2.0;
+  stencil_2D *st;
+
+  st = (stencil_2D *) malloc(sizeof(stencil_2D));
+  if (!st) nrerror("allocation failure in create_stencil_2D()");
+
+  st->nrows = nrows;
+  st->ncols = ncols;
+  st->stride = ncols + 2;
+  st->lanes = 1;
+  st->N = N;
+  size = (long) (nrows + 2) * st->stride;
+
+  st->site = ivector(1, N);
+  st->w0 = avector(0, size-1);
+  st->w2 = avector(0, size-1);
+  st->w4 = avector(0, size-1);
+  st->w6 = avector(0, size-1);
+  st->w8 = avector(0, size-1);
+  st->Vlat = avector(0, size-1);
+  st->Vnew = avector(0, size-1);
+
+  /* ghost sites and sites that are not nodes take no part */
+  for (s = 0; s < size; s++)
+    {
+    st->w0[s] = st->w2[s] = st->w4[s] = st->w6[s] = st->w8[s] = 0.0;
+    st->Vlat[s] = st->Vnew[s] = 0.0;
+    }
+
+  for (row = 1; row <= nrows; row++) for (col = 1; col <= ncols; col++)
+    {
+    n = geom[row][col];
+    if (n > 0)
+      {
+      s = row * st->stride + col;
+      st->site[n] = s;
+
+      Dnn6 = (nneighb[n][3] > 0) ? D[nneighb[n][3]] : D[n];
+      Dnn2 = (nneighb[n][1] > 0) ? D[nneighb[n][1]] : D[n];
+      Dnn4 = (nneighb[n][2] > 0) ? D[nneighb[n][2]] : D[n];
+      Dnn8 = (nneighb[n][4] > 0) ? D[nneighb[n][4]] : D[n];
+
+      dDdx = ((Dnn6 > 0) && (Dnn2 > 0) && (D[n] > 0)) ? (Dnn6 - Dnn2) / twodx : 0.0;
+      dDdy = ((Dnn8 > 0) && (Dnn4 > 0) && (D[n] > 0)) ? (Dnn8 - Dnn4) / twodx : 0.0;
+      if (scar == SCAR_THRESHOLD)
+        dDdx = dDdy = 0.0;
+
+      /* D*(d2V/dx2 + d2V/dy2) + dD/dx*dV/dx + dD/dy*dV/dy */
+      c6 = D[n] / dx2 + dDdx / twodx;
+      c2 = D[n] / dx2 - dDdx / twodx;
+      c8 = D[n] / dx2 + dDdy / twodx;
+      c4 = D[n] / dx2 - dDdy / twodx;
+      st->w0[s] = -4.0 * D[n] / dx2;
+
+      if (nneighb[n][1] > 0) st->w2[s] = c2; else st->w0[s] += c2;
+      if (nneighb[n][2] > 0) st->w4[s] = c4; else st->w0[s] += c4;
+      if (nneighb[n][3] > 0) st->w6[s] = c6; else st->w0[s] += c6;
+      if (nneighb[n][4] > 0) st->w8[s] = c8; else st->w0[s] += c8;
+      }
+    }
+
+  return st;
+}
+
+/***************************************************************
+
+ create_batch_stencil_2D
+
+ interleaves the stencils of S samples on the same lattice, so
+ that site s of sample l is held at index s*S + l (see batch_2D.c).
+ Every grid point is a node, numbered (row-1)*ncols + col, and a
+ grid point that is not a node in one of the samples has no
+ weights there, so its Vm is left as it is.
+
+***************************************************************/
+
+stencil_2D *create_batch_stencil_2D( stencil_2D **sample, int S )
+{
+  int row, col, n, s, l;
+  long size;
+  stencil_2D *st;
+
+  st = (stencil_2D *) malloc(sizeof(stencil_2D));
+  if (!st) nrerror("allocation failure in create_batch_stencil_2D()");
+
+  st->nrows = sample[0]->nrows;
+  st->ncols = sample[0]->ncols;
+  st->stride = sample[0]->stride;
+  st->lanes = S;
+  st->N = st->nrows * st->ncols;
+  size = (long) (st->nrows + 2) * st->stride * S;
+
+  st->site = ivector(1, st->N);
+  st->w0 = avector(0, size-1);
+  st->w2 = avector(0, size-1);
+  st->w4 = avector(0, size-1);
+  st->w6 = avector(0, size-1);
+  st->w8 = avector(0, size-1);
+  st->Vlat = avector(0, size-1);
+  st->Vnew = avector(0, size-1);
+
+  for (s = 0; s < size; s++)
+    st->Vlat[s] = st->Vnew[s] = 0.0;
+
+  for (row = 0; row <= st->nrows + 1; row++) for (col = 0; col <= st->ncols + 1; col++)
+    {
+    s = row * st->stride + col;
+    for (l = 0; l < S; l++)
+      {
+      st->w0[s*S + l] = sample[l]->w0[s];
+      st->w2[s*S + l] = sample[l]->w2[s];
+      st->w4[s*S + l] = sample[l]->w4[s];
+      st->w6[s*S + l] = sample[l]->w6[s];
+      st->w8[s*S + l] = sample[l]->w8[s];
+      }
+    if ((row >= 1) && (row <= st->nrows) && (col >= 1) && (col <= st->ncols))
+      {
+      n = (row - 1) * st->ncols + col;
+      st->site[n] = s;
+      }
+    }
+
+  return st;
+}
+
+/***************************************************************
+
+ free_stencil_2D
+
+***************************************************************/
+
+void free_stencil_2D( stencil_2D *st )
+{
+  long size = (long) (st->nrows + 2) * st->stride * st->lanes;
+
+  free_ivector(st->site, 1, st->N);
+  free_avector(st->w0, 0, size-1);
+  free_avector(st->w2, 0, size-1);
+  free_avector(st->w4, 0, size-1);
+  free_avector(st->w6, 0, size-1);
+  free_avector(st->w8, 0, size-1);
+  free_avector(st->Vlat, 0, size-1);
+  free_avector(st->Vnew, 0, size-1);
+  free(st);
+}
+
+/***************************************************************
+
+ stencil_sweep
+
+ W = V + half_dt * diffusion over the whole lattice. With lanes
+ interleaved the sites of a row are still one contiguous run, and
+ the neighbours are lanes and stride*lanes away.
+
+***************************************************************/
+
+static void stencil_sweep( stencil_2D *st, double *V, double *W, double half_dt )
+{
+  const int lanes = st->lanes;
+  const int stride = st->stride * lanes;
+  const int width = st->ncols * lanes;
+  int row, col, s;
+
+  double *w0 = st->w0, *w2 = st->w2, *w4 = st->w4, *w6 = st->w6, *w8 = st->w8;
+
+#pragma omp parallel for private(col, s)
+  for (row = 1; row <= st->nrows; row++)
+    {
+#pragma omp simd
+    for (col = lanes; col < lanes + width; col++)
+      {
+      s = row * stride + col;
+      W[s] = V[s] + half_dt * (w0[s]*V[s] + w2[s]*V[s-stride] + w4[s]*V[s+lanes]
+                               + w6[s]*V[s+stride] + w8[s]*V[s-lanes]);
+      }
+    }
+}
+
+/***************************************************************
+
+ diffusion_2D
+
+ Vout[n] = Vin[n] + half_dt * diffusion, for all nodes n, with
+ spatially varying D. The voltage is copied onto the lattice and
+ the whole grid is updated in one stencil sweep. With lanes > 1
+ the lanes of node n are Vin[(n-1)*lanes + 1 .. n*lanes].
+
+***************************************************************/
+
+void diffusion_2D( stencil_2D *st, double *Vin, double *Vout, double half_dt )
+{
+/* Work out isotropic diffusion */
+
+  const int L = st->lanes;
+  int n, l;
+
+#pragma omp parallel for private(l)
+  for (n = 1; n <= st->N; n++)
+    for (l = 0; l < L; l++)
+      st->Vlat[st->site[n]*L + l] = Vin[(n-1)*L + 1 + l];
+
+  stencil_sweep( st, st->Vlat, st->Vnew, half_dt );
+
+#pragma omp parallel for private(l)
+  for (n = 1; n <= st->N; n++)
+    for (l = 0; l < L; l++)
+      Vout[(n-1)*L + 1 + l] = st->Vnew[st->site[n]*L + l];
+
+}
+
+/***************************************************************
+
+ diffusion_2D_step
+
+ the diffusion part of a time step, two half steps of half_dt
+ one after the other. The lattice buffers are used in turn so
+ that nothing is copied between the half steps, and the results
+ are taken off the lattice in a single pass over the nodes:
+
+   Vm      Vm after the first half step
+   new_Vm  Vm after the second half step
+   old_Vm  new_Vm as it was on entry
+   dVdt    new_Vm - old_Vm
+
+***************************************************************/
+
+void diffusion_2D_step( stencil_2D *st, double *Vm, double *new_Vm, double *old_Vm, double *dVdt, double half_dt )
+{
+  const int L = st->lanes;
+  int n, l, i, s;
+  double Vold;
+
+#pragma omp parallel for private(l)
+  for (n = 1; n <= st->N; n++)
+    for (l = 0; l < L; l++)
+      st->Vlat[st->site[n]*L + l] = Vm[(n-1)*L + 1 + l];
+
+  stencil_sweep( st, st->Vlat, st->Vnew, half_dt );
+  stencil_sweep( st, st->Vnew, st->Vlat, half_dt );
+
+#pragma omp parallel for private(l, i, s, Vold)
+  for (n = 1; n <= st->N; n++)
+    for (l = 0; l < L; l++)
+      {
+      i = (n-1)*L + 1 + l;
+      s = st->site[n]*L + l;
+      Vold = new_Vm[i];
+      Vm[i] = st->Vnew[s];
+      new_Vm[i] = st->Vlat[s];
+      old_Vm[i] = Vold;
+      dVdt[i] = new_Vm[i] - Vold;
+      }
+
+}
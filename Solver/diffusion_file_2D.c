@@ -0,0 +1,201 @@
+/***************************************************************
+
+ diffusion_file_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ The diffusion coefficients can be read from a text file
+ (DiffusionCoefficient.txt, one row of the grid per line) or from
+ a binary file
+
+   diffusion_header
+   float D[nrows][ncols]      row by row, as in the text file
+
+ which is recognised from the magic number at the start, so either
+ can be given as DIFFUSIONFILE. The data follow a 32 byte header,
+ so the file can be mapped and used as it is. The header holds
+ the size of the grid and a hash of the data, which are checked
+ when it is read. Utilities/diffusion2bin.c converts a text file
+ to a binary file. The per-node parameter maps (see cellmap_2D.c)
+ are read in the same way.
+
+***************************************************************/
+
+static uint64_t hash_floats( float *data, long count )
+{
+  return hash_data_2D( data, count * (long) sizeof(float) );
+}
+
+/* stops with an error about the file given as name */
+static void grid_error( char *name, char *text )
+{
+  printf("%s: %s\n", name, text);
+  nrerror("error reading file\n");
+}
+
+/***************************************************************
+
+ read_grid_2D
+
+ reads one value for each grid point into D[(row-1)*ncols + col],
+ for row = 1..nrows and col = 1..ncols, from a text or binary file
+ in the layout of a diffusion file. Stops with an error if the file
+ is short, or holds anything that is not a number. name is the
+ setting the file was given as, for the messages.
+
+***************************************************************/
+
+void read_grid_2D( char *fname, char *name, int nrows, int ncols, double *D )
+{
+  const long RC = (long) nrows * ncols;
+  diffusion_header hdr;
+  float *data, dTemp;
+  char extra[64];
+  long n, size;
+  int row, col;
+  FILE *fp;
+
+  fp = fopen(fname, "rb");
+  if (!fp)
+    {
+    printf("%s: cannot open %s\n", name, fname);
+    nrerror("cannot open file\n");
+    }
+
+  if ((fread(&hdr, sizeof(hdr), 1, fp) == 1) && (memcmp(hdr.magic, DIFFUSION_MAGIC, 8) == 0))
+    {
+    if (hdr.version != DIFFUSION_VERSION)
+      grid_error(name, "unknown version");
+    if ((hdr.nrows != nrows) || (hdr.ncols != ncols))
+      {
+      printf("%s is %d x %d, grid is %d x %d\n", name, hdr.nrows, hdr.ncols, nrows, ncols);
+      grid_error(name, "does not match the grid");
+      }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    if (size != (long) sizeof(hdr) + RC * (long) sizeof(float))
+      grid_error(name, "has the wrong size");
+
+    data = (float *) malloc(RC * sizeof(float));
+    if (!data) nrerror("allocation failure in read_grid_2D()");
+    fseek(fp, sizeof(hdr), SEEK_SET);
+    if (fread(data, sizeof(float), RC, fp) != (size_t) RC)
+      grid_error(name, "cannot read data");
+    if (hash_floats(data, RC) != hdr.hash)
+      grid_error(name, "is corrupt (hash does not match)");
+
+    for (n = 0; n < RC; n++)
+      {
+      if (!isfinite(data[n]))
+        grid_error(name, "holds a value that is not a number");
+      D[n + 1] = data[n];
+      }
+    free(data);
+    printf("read %d x %d binary %s\n", nrows, ncols, name);
+    }
+  else
+    {
+    /* text file, as read by earlier versions */
+    rewind(fp);
+    for (row = 1; row <= nrows; row++)
+      for (col = 1; col <= ncols; col++)
+        {
+        if ((fscanf(fp, "%f ", &dTemp) != 1) || !isfinite(dTemp))
+          {
+          printf("%s row %d column %d: %s\n", name, row, col, feof(fp) ? "end of file" : "not a number");
+          grid_error(name, "cannot read data");
+          }
+        D[(row - 1) * ncols + col] = dTemp;
+        }
+    if (fscanf(fp, "%63s", extra) == 1)
+      printf("%s has more than %d x %d values, the rest are not used\n", name, nrows, ncols);
+    }
+
+  fclose(fp);
+}
+
+/***************************************************************
+
+ read_diffusion_2D
+
+ reads the diffusion coefficients into D[(row-1)*ncols + col], for
+ row = 1..nrows and col = 1..ncols, from a text or binary file
+
+***************************************************************/
+
+void read_diffusion_2D( char *fname, int nrows, int ncols, double *D )
+{
+  read_grid_2D( fname, "DIFFUSIONFILE", nrows, ncols, D );
+}
+
+/***************************************************************
+
+ write_diffusion_bin_2D
+
+ writes D[(row-1)*ncols + col] to a binary diffusion file
+
+***************************************************************/
+
+int write_diffusion_bin_2D( char *fname, double *D, int nrows, int ncols )
+{
+  const long RC = (long) nrows * ncols;
+  diffusion_header hdr;
+  float *data;
+  long n;
+  int ok;
+  FILE *fp;
+
+  data = (float *) malloc(RC * sizeof(float));
+  if (!data) nrerror("allocation failure in write_diffusion_bin_2D()");
+  for (n = 0; n < RC; n++)
+    data[n] = (float) D[n + 1];
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, DIFFUSION_MAGIC, 8);
+  hdr.version = DIFFUSION_VERSION;
+  hdr.nrows = nrows;
+  hdr.ncols = ncols;
+  hdr.hash = hash_floats(data, RC);
+
+  ok = 0;
+  fp = fopen(fname, "wb");
+  if (fp)
+    {
+    ok = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1) && (fwrite(data, sizeof(float), RC, fp) == (size_t) RC);
+    ok = (fclose(fp) == 0) && ok;
+    }
+  if (!ok)
+    printf("cannot write %s\n", fname);
+
+  free(data);
+  return ok;
+}
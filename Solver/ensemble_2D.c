@@ -0,0 +1,280 @@
+/***************************************************************
+
+ ensemble_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+/***************************************************************
+
+ Runs a set of simulations, one for each DiffusionCoefficient.txt
+ listed in the ensemble file, from a single process. Each sample
+ is run by a child process started with fork() once the lookup
+ table has been built, so the table and the code are shared and
+ are not set up again for each sample. Each sample runs in the
+ directory that holds its diffusion file, where its output and
+ the screen output (OUTPUTFILEROOT log.txt) are written. Up to
+ jobs samples run at once, with the cores shared between them.
+
+ The ensemble file has one diffusion file per line, and anything
+ after # is ignored. The files that every sample reads (the seed
+ and the cell parameter maps) are found from the directory the
+ ensemble was started in, as they are with -batch, and output
+ files are written in the directory of each sample.
+
+***************************************************************/
+
+static double wall_time( void )
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1.0e-6 * tv.tv_usec;
+}
+
+static int read_ensemble( char *fname, char ***list )
+{
+  char line[CONFIG_STRLEN], path[CONFIG_STRLEN], *p;
+  int num = 0, size = 64;
+  FILE *fp;
+
+  fp = fopen( fname, "r" );
+  if (!fp) nrerror("cannot open ensemble file");
+
+  *list = (char **) malloc(size * sizeof(char *));
+  while (fgets(line, sizeof(line), fp))
+    {
+    if ((p = strchr(line, '#')) != NULL) *p = '\0';
+    if (sscanf(line, "%255s", path) != 1)
+      continue;
+    if (num == size)
+      {
+      size *= 2;
+      *list = (char **) realloc(*list, size * sizeof(char *));
+      }
+    (*list)[num] = (char *) malloc(strlen(path) + 1);
+    strcpy((*list)[num++], path);
+    }
+  fclose(fp);
+
+  return (num);
+}
+
+/* makes a relative path to an input file absolute, so that it is */
+/* still found once a sample has moved to its own directory */
+static void absolute_path( char *path )
+{
+  char full[PATH_MAX];
+
+  if ((path[0] == '\0') || (path[0] == '/'))
+    return;
+  if (!realpath(path, full))
+    {
+    perror(path);
+    nrerror("cannot find an input file of the ensemble");
+    }
+  if (strlen(full) >= CONFIG_STRLEN)
+    nrerror("path of an input file of the ensemble is too long");
+  strcpy(path, full);
+}
+
+/* moves to the directory of sample and sets up the run there */
+static void start_sample( config_2D *c, char *sample, int threads )
+{
+  char fname[CONFIG_STRLEN + 16];
+  char *p;
+
+  p = strrchr(sample, '/');
+  if (p)
+    {
+    *p = '\0';
+    if (chdir(sample) != 0)
+      {
+      perror(sample);
+      exit(1);
+      }
+    p++;
+    }
+  else
+    p = sample;
+  strcpy(c->diffusionFile, p);
+
+  if ((mkdir("STFfiles", 0755) != 0) && (errno != EEXIST))
+    perror("cannot create STFfiles");
+
+  sprintf(fname, "%slog.txt", c->outputRoot);
+  if (!freopen(fname, "w", stdout))
+    perror(fname);
+
+  c->ensemble[0] = '\0';
+  c->threads = threads;
+}
+
+/***************************************************************
+
+ run_ensemble_2D
+
+ returns the number of the sample (from 0) in each child process,
+ which then carries on with the simulation. The parent returns
+ once all the samples have finished, with -1 less the number of
+ samples that failed. The time taken and exit status of each
+ sample are written to ensemble_timing.txt.
+
+ With batch > 1 the samples are taken batch at a time, and each
+ child advances its batch together with run_batch_2D() and exits,
+ so the time recorded for a sample is that of its batch.
+
+***************************************************************/
+
+int run_ensemble_2D( config_2D *c, lookup_2D *lookup )
+{
+  char **list;
+  char fname[32];
+  int num, batch, numUnits, next = 0, running = 0, failed = 0;
+  int i, s, first, count, jobs, threads, status;
+  pid_t pid, *pids;
+  double *start, *elapsed, t0;
+  int *result;
+  FILE *fp;
+
+  num = read_ensemble(c->ensemble, &list);
+  if (num == 0) nrerror("no samples in ensemble file");
+
+  absolute_path(c->seedFile);
+  absolute_path(c->gNaMap);
+  absolute_path(c->gKsMap);
+  absolute_path(c->gCaLMap);
+  absolute_path(c->atpMap);
+
+  batch = (c->batch > 1) ? c->batch : 1;
+  if (batch > SIMD_BLOCK)
+    {
+    printf("at most %d samples can be run in a batch\n", SIMD_BLOCK);
+    batch = SIMD_BLOCK;
+    }
+  numUnits = (num + batch - 1) / batch;
+
+  jobs = (c->jobs > 0) ? c->jobs : 1;
+  if (jobs > numUnits) jobs = numUnits;
+
+  threads = c->threads;
+#ifdef _OPENMP
+  if (threads <= 0)
+    threads = omp_get_num_procs() / jobs;
+#endif
+  if (threads <= 0) threads = 1;
+  printf("ensemble of %d samples in batches of %d, %d at a time with %d threads each\n",
+    num, batch, jobs, threads);
+
+  pids = (pid_t *) malloc(numUnits * sizeof(pid_t));
+  start = (double *) malloc(numUnits * sizeof(double));
+  elapsed = (double *) malloc(numUnits * sizeof(double));
+  result = (int *) malloc(numUnits * sizeof(int));
+
+  t0 = wall_time();
+  while ((next < numUnits) || (running > 0))
+    {
+    while ((running < jobs) && (next < numUnits))
+      {
+      first = next * batch;
+      count = (num - first < batch) ? num - first : batch;
+      fflush(stdout);
+      pid = fork();
+      if (pid < 0)
+        nrerror("cannot start ensemble sample");
+      if (pid == 0)
+        {
+        if (batch == 1)
+          {
+          start_sample(c, list[next], threads);
+          return (next);
+          }
+
+        /* a batch writes to the directories of its samples from here */
+        sprintf(fname, "batch%03d_log.txt", next);
+        if (!freopen(fname, "w", stdout))
+          perror(fname);
+        c->threads = threads;
+        exit(run_batch_2D(c, lookup, &list[first], count));
+        }
+      pids[next] = pid;
+      start[next] = wall_time();
+      if (batch == 1)
+        printf("sample %d: %s started\n", next, list[next]);
+      else
+        printf("batch %d: samples %d to %d started\n", next, first, first + count - 1);
+      next++;
+      running++;
+      }
+
+    pid = wait(&status);
+    if (pid < 0)
+      break;
+    for (i = 0; i < next; i++)
+      if (pids[i] == pid)
+        {
+        elapsed[i] = wall_time() - start[i];
+        result[i] = (WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+        first = i * batch;
+        count = (num - first < batch) ? num - first : batch;
+        if (result[i] != 0) failed += count;
+        if (batch == 1)
+          printf("sample %d: %s finished in %.1f s%s\n", i, list[i], elapsed[i],
+            (result[i] == 0) ? "" : ", failed");
+        else
+          printf("batch %d: samples %d to %d finished in %.1f s%s\n", i, first, first + count - 1,
+            elapsed[i], (result[i] == 0) ? "" : ", failed");
+        running--;
+        }
+    }
+
+  printf("ensemble finished in %.1f s, %d of %d samples failed\n", wall_time() - t0, failed, num);
+  fp = fopen("ensemble_timing.txt", "w");
+  if (fp)
+    {
+    for (s = 0; s < num; s++)
+      fprintf(fp, "%d %s %.2f %d\n", s, list[s], elapsed[s / batch], result[s / batch]);
+    fclose(fp);
+    }
+
+  for (s = 0; s < num; s++)
+    free(list[s]);
+  free(list);
+  free(pids);
+  free(start);
+  free(elapsed);
+  free(result);
+
+  return (-1 - failed);
+}
@@ -0,0 +1,308 @@
+/***************************************************************
+
+ grf_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ Scar represented as a Gaussian random field, as made by
+ Utilities/MakePatchyScar_isthmus.m. A stationary Gaussian random
+ field with mean 0, SD 1 and covariance exp(-h^2/lengthScale^2)
+ is sampled by circulant embedding (Kroese and Botev 2015), and
+ the diffusion coefficient is then found from it with the same
+ sigmoid scar and border zone as calculateD(), and optionally
+ with the same random removal of tissue.
+
+ The Matlab code embeds the covariance in a (2n-1) x (2m-1) grid.
+ Here the grid is the next power of 2 at least twice the size in
+ each direction, so that a plain radix 2 FFT can be used, and the
+ random numbers come from a seeded generator, so the fields have
+ the same statistics as those from the Matlab code but are not
+ the same fields.
+
+***************************************************************/
+
+/* splitmix64, uniform on (0, 1), and normal by Box-Muller */
+static uint64_t grf_next( uint64_t *state )
+{
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static double grf_uniform( uint64_t *state )
+{
+  return ((grf_next(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static void grf_normal( uint64_t *state, double *x, double *y )
+{
+  double r = sqrt(-2.0 * log(grf_uniform(state)));
+  double theta = 2.0 * M_PI * grf_uniform(state);
+
+  *x = r * cos(theta);
+  *y = r * sin(theta);
+}
+
+/***************************************************************
+
+ grf_fft
+
+ in place forward FFT of n (a power of 2) complex values held at
+ re[k*stride], im[k*stride], with twiddle factors tw[0..n/2-1]
+
+***************************************************************/
+
+static void grf_fft( double *re, double *im, int n, int stride, double *twr, double *twi )
+{
+  int i, j, k, len, half, step, a, b;
+  double tr, ti, wr, wi;
+
+  /* bit reversal */
+  for (i = 1, j = 0; i < n; i++)
+    {
+    k = n >> 1;
+    while (j & k)
+      {
+      j ^= k;
+      k >>= 1;
+      }
+    j |= k;
+    if (i < j)
+      {
+      tr = re[i*stride]; re[i*stride] = re[j*stride]; re[j*stride] = tr;
+      ti = im[i*stride]; im[i*stride] = im[j*stride]; im[j*stride] = ti;
+      }
+    }
+
+  for (len = 2; len <= n; len <<= 1)
+    {
+    half = len >> 1;
+    step = n / len;
+    for (i = 0; i < n; i += len)
+      for (k = 0; k < half; k++)
+        {
+        wr = twr[k*step];
+        wi = twi[k*step];
+        a = (i + k) * stride;
+        b = (i + k + half) * stride;
+        tr = re[b]*wr - im[b]*wi;
+        ti = re[b]*wi + im[b]*wr;
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+        }
+    }
+}
+
+/* FFT of each row and then each column of an n1 x n2 array */
+static void grf_fft2( double *re, double *im, int n1, int n2 )
+{
+  double *twr, *twi;
+  int i, n;
+
+  n = (n1 > n2) ? n1 : n2;
+  twr = (double *) malloc((n/2 + 1) * sizeof(double));
+  twi = (double *) malloc((n/2 + 1) * sizeof(double));
+
+  for (i = 0; i < n2/2; i++)
+    {
+    twr[i] = cos(2.0 * M_PI * i / n2);
+    twi[i] = -sin(2.0 * M_PI * i / n2);
+    }
+#pragma omp parallel for
+  for (i = 0; i < n1; i++)
+    grf_fft( &re[i*n2], &im[i*n2], n2, 1, twr, twi );
+
+  for (i = 0; i < n1/2; i++)
+    {
+    twr[i] = cos(2.0 * M_PI * i / n1);
+    twi[i] = -sin(2.0 * M_PI * i / n1);
+    }
+#pragma omp parallel for
+  for (i = 0; i < n2; i++)
+    grf_fft( &re[i], &im[i], n1, n2, twr, twi );
+
+  free(twr);
+  free(twi);
+}
+
+/***************************************************************
+
+ make_grf_2D
+
+ f[(row-1)*ncols + col] for row = 1..nrows, col = 1..ncols is set
+ to a sample of a Gaussian random field with mean 0, SD 1 and
+ covariance exp(-h^2/lengthScale^2), with h in grid points
+
+***************************************************************/
+
+void make_grf_2D( double *f, int nrows, int ncols, double lengthScale, uint64_t seed )
+{
+  int m1 = 1, m2 = 1, i, j, di, dj;
+  double *re, *im, lam, lamMin = 0.0, x, y;
+  uint64_t state = seed;
+
+  while (m1 < 2 * nrows) m1 <<= 1;
+  while (m2 < 2 * ncols) m2 <<= 1;
+  re = (double *) malloc((size_t) m1 * m2 * sizeof(double));
+  im = (double *) malloc((size_t) m1 * m2 * sizeof(double));
+  if (!re || !im) nrerror("allocation failure in make_grf_2D()");
+
+  /* first row of the block circulant covariance matrix */
+  for (i = 0; i < m1; i++)
+    for (j = 0; j < m2; j++)
+      {
+      di = (i < m1 - i) ? i : m1 - i;
+      dj = (j < m2 - j) ? j : m2 - j;
+      re[i*m2 + j] = exp(-((double) di*di + (double) dj*dj) / (lengthScale*lengthScale));
+      im[i*m2 + j] = 0.0;
+      }
+
+  /* its eigenvalues, and the field from complex normal weights */
+  grf_fft2( re, im, m1, m2 );
+  for (i = 0; i < m1*m2; i++)
+    {
+    lam = re[i] / ((double) m1 * m2);
+    if (lam < lamMin) lamMin = lam;
+    lam = (lam > 0.0) ? sqrt(lam) : 0.0;
+    grf_normal( &state, &x, &y );
+    re[i] = lam * x;
+    im[i] = lam * y;
+    }
+  if (lamMin < -1.0e-10)
+    printf("GRF covariance embedding is not positive definite (smallest eigenvalue %g), field is approximate\n", lamMin);
+  grf_fft2( re, im, m1, m2 );
+
+  for (i = 0; i < nrows; i++)
+    for (j = 0; j < ncols; j++)
+      f[i*ncols + j + 1] = re[i*m2 + j];
+
+  free(re);
+  free(im);
+}
+
+/***************************************************************
+
+ make_scar_2D
+
+ D[(row-1)*ncols + col] is set to the diffusion coefficient from
+ a Gaussian random field (see calculateD() and writeToFile() in
+ MakePatchyScar_isthmus.m), rounded to 0.001 as in the text file
+ so that a run with the field in memory is the same as one that
+ reads it back from the file. With removal set, each grid point
+ is removed (D = -1) with probability 1 - 20 D.
+
+***************************************************************/
+
+void make_scar_2D( double *D, int nrows, int ncols, double lengthScale, uint64_t seed, int removal )
+{
+  const double maxD = GRF_MAXD;
+  const double minD = GRF_MIND;
+  const double rInner = GRF_RINNER;        // radius of scar core
+  const double rOuter = GRF_ROUTER;        // radius of border zone
+  const double slope = GRF_SLOPE;          // slope of sigmoid function
+  int row, col, n;
+  double DGRF, x1, y1, x2, y2, r1, r2, infarct1, infarct2, border1, border2, d;
+  uint64_t state = ~seed;
+
+  make_grf_2D( D, nrows, ncols, lengthScale, seed );
+
+  for (row = 1; row <= nrows; row++)
+    for (col = 1; col <= ncols; col++)
+      {
+      n = (row - 1) * ncols + col;
+      DGRF = maxD * (D[n] + 2.0) / 4.0;
+
+      /* infarct field 1 */
+      x1 = col - ncols/3.0;
+      y1 = row - 2.0*nrows/3.0;
+      r1 = sqrt(x1*x1 + y1*y1);
+      infarct1 = 1.0/(1.0 + exp(slope * (r1 - rInner)));
+      border1 = 1.0/(1.0 + exp(slope * (r1 - rOuter)));
+
+      /* infarct field 2 */
+      x2 = col - 2.0*ncols/3.0;
+      y2 = row - nrows/3.0;
+      r2 = sqrt(x2*x2 + y2*y2);
+      infarct2 = 1.0/(1.0 + exp(slope * (r2 - rInner)));
+      border2 = 1.0/(1.0 + exp(slope * (r2 - rOuter)));
+
+      d = maxD * (border1 * border2) + (infarct1 * infarct2) * DGRF;
+      if (d < minD)
+        d = minD - 0.001;
+      if (d > maxD)
+        d = maxD;
+
+      if (removal && (grf_uniform(&state) > 20.0 * d))
+        d = -1.0;
+
+      D[n] = floor(d * 1000.0 + 0.5) / 1000.0;
+      }
+}
+
+/***************************************************************
+
+ write_scar_2D
+
+ writes D to a text file in the layout of DiffusionCoefficient.txt,
+ or to a binary diffusion file if fname ends in .bin
+
+***************************************************************/
+
+int write_scar_2D( char *fname, double *D, int nrows, int ncols )
+{
+  int row, col;
+  size_t len = strlen(fname);
+  FILE *fp;
+
+  if ((len > 4) && (strcmp(fname + len - 4, ".bin") == 0))
+    return write_diffusion_bin_2D( fname, D, nrows, ncols );
+
+  fp = fopen( fname, "w" );
+  if (!fp)
+    {
+    printf("cannot open %s\n", fname);
+    return 0;
+    }
+  for (row = 1; row <= nrows; row++)
+    {
+    for (col = 1; col <= ncols; col++)
+      fprintf(fp, "%5.3f ", D[(row - 1) * ncols + col]);
+    fprintf(fp, "\n");
+    }
+  fclose(fp);
+
+  return 1;
+}
@@ -0,0 +1,149 @@
+/***************************************************************
+
+ initialise_geometry_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/* sets up the geometry for one of the scar models
+
+   SCAR_CONTINUOUS  every grid point is a node, with D as read and
+                    D = 0 where D <= 0 (ContinuousD)
+   SCAR_SMOOTH      grid points with D <= SCAR_DMIN are not part of
+                    the tissue and form no-flux boundaries, D as read
+                    elsewhere (SmoothD)
+   SCAR_THRESHOLD   as SCAR_SMOOTH, with D = SCAR_DTHRESHOLD
+                    elsewhere (ThresholdD)
+
+   D is read from config.diffusionFile, as text or binary (see
+   diffusion_file_2D.c), or with config.grf set it is made in memory
+   from a Gaussian random field (see grf_2D.c) */
+
+int initialise_geometry_2D( int **geom, int nrows, int ncols, int **nneighb, double *D, int scar )
+{
+
+  int row, col, n;
+  int N;
+  float dTemp = 0.0;
+  double *Dgrid;
+
+  /* nodes are numbered with int, and so are sites on the lattice */
+  /* (with its ghost ring) in diffusion_2D.c */
+  if ((nrows < 1) || (ncols < 1) || ((long) (nrows + 2) * (ncols + 2) > INT_MAX))
+    nrerror("grid is too large");
+
+  Dgrid = fvector(1, (long) nrows * ncols);
+  if (config.grf > 0.0)
+    {
+    /* scar from a Gaussian random field, written out if asked */
+    printf("making scar with length scale %g, seed %d\n", config.grf, config.grfSeed);
+    make_scar_2D( Dgrid, nrows, ncols, config.grf, (uint64_t) config.grfSeed, config.grfRemove );
+    if (config.grfOut[0])
+      write_scar_2D( config.grfOut, Dgrid, nrows, ncols );
+    }
+  else
+    read_diffusion_2D( config.diffusionFile, nrows, ncols, Dgrid );
+
+  /* read in diffusion information from file */
+  n = 1;
+  for (row = 1; row <= nrows; row++)
+    {
+    for (col = 1; col <= ncols; col++)    
+      {
+      dTemp = (float) Dgrid[(long) (row - 1) * ncols + col];
+      
+      if ((scar != SCAR_CONTINUOUS) && (dTemp <= SCAR_DMIN))
+        {
+        geom[row][col] = -1;
+        }
+      else if (dTemp <= 0)
+        {
+        //geom[row][col] = -1;
+        geom[row][col] = n;
+        D[n] = 0.0;
+        n++;
+        }
+      else
+        {
+        geom[row][col] = n;
+        D[n] = (scar == SCAR_THRESHOLD) ? SCAR_DTHRESHOLD : (double) dTemp;
+        n++;
+        }
+      }
+    }
+    
+  printf("Successfully read %d entries from DIFFUSIONFILE\n",n);
+  free_fvector(Dgrid, 1, (long) nrows * ncols);
+  N = n-1;
+    
+  /* now work out nearest neighbours, only the four used by the */
+  /* stencil (see diffusion_2D.c) are kept */
+
+  /*    1
+      4   2
+        3    */
+
+  /* grid points on the boundary are identified by nneighb of 0 */
+
+  for (row = 1; row <= nrows; row++ ) for (col = 1; col <= ncols; col++)
+    {
+    if (geom[row][col] > 0)
+      {
+      n = geom[row][col];
+      nneighb[n][1] = (row>1)                    ? geom[row-1][col]   :0;
+      nneighb[n][2] = (col<ncols)                ? geom[row][col+1]   :0;
+      nneighb[n][3] = (row<nrows)                ? geom[row+1][col]   :0;
+      nneighb[n][4] = (col>1)                    ? geom[row][col-1]   :0;
+      }
+    }
+  return(N);
+}
+
+/* sets node[k] to the node at each electrogram probe in config, */
+/* or 0 where the probe is outside the grid or in a hole in the */
+/* tissue, and returns the number of probes */
+
+int probe_nodes_2D( int **geom, int nrows, int ncols, int *node )
+{
+  int k, row, col;
+
+  for (k = 0; k < config.numProbes; k++)
+    {
+    row = config.probeRow[k];
+    col = config.probeCol[k];
+    if ((row > nrows) || (col > ncols))
+      {
+      printf("electrogram probe %d:%d is outside the grid, written as 0\n", row, col);
+      node[k] = 0;
+      }
+    else
+      node[k] = (geom[row][col] > 0) ? geom[row][col] : 0;
+    }
+  return (config.numProbes);
+}
@@ -0,0 +1,168 @@
+
+/***************************************************************
+
+ initialise_variables.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+ 
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton, 
+ Department of Computer Science, 
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include <TP06_OpSplit_2D.h>
+
+void initialise_variables_2D( state_2D *u, int N )
+{
+
+  int n,m;
+
+  /* Indices for u array */
+  int V =      1;
+  int M =      2;
+  int H =      3;
+  int J =      4;
+  int R =      5;
+  int S =      6;
+  int D =      7;
+  int F =      8;
+  int F2 =     9;
+  int FCass = 10;
+  int Xr1 =   11;
+  int Xr2 =   12;
+  int Xs =    13;
+  int RR =    14;
+  int OO =    15;
+  int CaSS =  16;
+  int CaSR =  17;
+  int Cai =   18;
+  int Nai =   19;
+  int Ki =    20;
+  
+  /* Initial Gate Conditions */
+  // original commented out
+  // new values from CellML
+  for (n = 1; n <= N; n++)
+    {
+  /*  u->var[V][n] = -86.2;
+    u->var[M][n] = 0.0;
+    u->var[H][n] = 0.75;
+    u->var[J][n] = 0.75;
+    u->var[Xr1][n] = 0.0;
+    u->var[Xr2][n] = 1.0;
+    u->var[Xs][n] = 0.0;
+    u->var[R][n] = 0.0;
+    u->var[S][n] = 1.0;
+    u->var[D][n] = 0.0;
+    u->var[F][n] = 1.0;
+    u->var[F2][n] = 1.0;
+    u->var[FCass][n] = 1.0;
+    u->var[RR][n] = 1.0;
+    u->var[OO][n] = 0.0;
+    u->var[Cai][n] = 0.00007;
+    u->var[CaSR][n] = 3.0; //1.3;
+    u->var[CaSS][n] = 0.00007;
+    u->var[Nai][n] = 7.67;
+    u->var[Ki][n] = 138.3; */
+
+    u->var[V][n]     = -85.23;
+    u->var[M][n]     = 0.00172;
+    u->var[H][n]     = 0.7444;
+    u->var[J][n]     = 0.7045;
+    u->var[Xr1][n]   = 0.000621;
+    u->var[Xr2][n]   = 0.4712;
+    u->var[Xs][n]    = 0.0095;
+    u->var[R][n]     = 0.0000000242;
+    u->var[S][n]     = 0.999998;
+    u->var[D][n]    = 0.00003373;
+    u->var[F][n]     = 0.7888;
+    u->var[F2][n]    = 0.9755;
+    u->var[FCass][n] = 0.9953;
+    u->var[RR][n]    = 0.9073;
+    u->var[OO][n]    = 0.0;
+    u->var[Cai][n]   = 0.000126;
+    u->var[CaSR][n]  = 3.64;
+    u->var[CaSS][n]  = 0.00036;
+    u->var[Nai][n]   = 8.604;
+    u->var[Ki][n]    = 136.89;
+
+    }
+
+}
+
+/***************************************************************
+
+ seed_variables_2D
+
+ sets every node to the state U
+
+***************************************************************/
+
+void seed_variables_2D( state_2D *u, int N, double *U )
+{
+  int n, m;
+
+  for (m = 1; m <= NUM_STATES; m++)
+    for (n = 1; n <= N; n++)
+      u->var[m][n] = U[m];
+}
+
+/***************************************************************
+
+ pace_cell_2D
+
+ paces a single cell in the state U for numBeats beats at cycle
+ length bcl, with the same stimulus and adaptive time step as a
+ node in the tissue, and leaves U as it is just before the next
+ stimulus would be due
+
+***************************************************************/
+
+void pace_cell_2D( double *U, lookup_2D *lookup, double bcl, int numBeats )
+{
+  const int V = 1;
+  const double dt = config.dt;
+  int t, k, kmax, ko, tmax;
+  double time, dtshort, dV, dVdt = 0.0, Vold, stimCurrent;
+
+  tmax = (int) (numBeats * bcl / dt + 0.5);
+  for (t = 0; t < tmax; t++)
+    {
+    time = t * dt;
+    stimCurrent = (fmod(time, bcl) <= 2.0) ? -52.0 : 0.0;
+
+    if (dVdt > 0.01) ko = 5; else ko = 1;
+    kmax = ko + floor(fabs(dVdt) * 20.0);
+    if (kmax > ceil(dt/0.01))
+      kmax = dt/0.01;
+    dtshort = dt / (double) kmax;
+
+    Vold = U[V];
+    for (k = 1; k <= kmax; k++)
+      {
+      dV = dtshort * calculate_TP06_current_OpSplit( U, dtshort, lookup, NULL, 0, stimCurrent );
+      U[V] = U[V] - dV;
+      }
+    dVdt = U[V] - Vold;
+    }
+}
@@ -46,6 +46,24 @@ double *fvector( long nl, long nh )
    return v-nl+NR_END;
 }
 
+/***************************************************************
+
+ avector
+ allocates space for a double vector with subscript range
+ v[nl..nh], with v[nl] aligned to a cache line so that whole
+ arrays can be streamed through and vectorised
+
+***************************************************************/
+
+double *avector( long nl, long nh )
+{
+   void *v;
+
+   if (posix_memalign(&v, ALIGNMENT, (size_t) ((nh-nl+1)*sizeof(double))) != 0)
+     nrerror("allocation failure in avector()");
+   return (double *)v-nl;
+}
+
 /***************************************************************
 
 Routine ivector - allocates space for an int vector with 
@@ -218,6 +236,18 @@ void free_fvector(double *v, long nl, long nh)
   free((FREE_ARG) (v+nl-NR_END));
 }
 
+/**************************************************************
+
+ free_avector
+ frees aligned double vector with subscript range v[nl..nh]
+
+***************************************************************/
+
+void free_avector(double *v, long nl, long nh)
+{
+  free((FREE_ARG) (v+nl));
+}
+
 /**************************************************************
 
  free_fmatrix
@@ -0,0 +1,295 @@
+/***************************************************************
+
+ snapshot_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ Binary snapshots of Vm, all appended to one file per run
+
+   snapshot_header
+   snapshot_frame, data      one per snapshot
+   ...
+   snapshot_index            one per snapshot, written on close
+   snapshot_trailer
+
+ The data for each snapshot are the nx x ny grid in the same
+ order as an stf file (row by row), with -100 where there is no
+ node, as float or as short holding Vm * SNAPSHOT_SCALE. When
+ built with -DUSE_ZLIB the data are deflated. If a run stops
+ before the file is closed the index is missing, and the frames
+ can still be read one after the other from the start of the
+ file. Utilities/snapshot2stf.c converts the file back to stf
+ files.
+
+***************************************************************/
+
+#include <unistd.h>
+
+/***************************************************************
+
+ new_snapshot_file and add_index
+
+ new_snapshot_file sets up the buffers for a file that is already
+ open, and add_index adds a snapshot to the index
+
+***************************************************************/
+
+static snapshot_file *new_snapshot_file( FILE *fp, int nx, int ny, int encoding )
+{
+  snapshot_file *sf;
+
+  sf = (snapshot_file *) malloc(sizeof(snapshot_file));
+  if (!sf) nrerror("allocation failure in open_snapshots_2D()");
+
+  sf->fp = fp;
+  sf->nx = nx;
+  sf->ny = ny;
+  sf->encoding = encoding;
+  sf->count = 0;
+  sf->size = 64;
+  sf->index = (snapshot_index *) malloc(sf->size * sizeof(snapshot_index));
+
+  sf->rawBytes = nx * ny * ((encoding == SNAPSHOT_INT16) ? sizeof(int16_t) : sizeof(float));
+  sf->raw = malloc(sf->rawBytes);
+#ifdef USE_ZLIB
+  sf->packedBytes = compressBound(sf->rawBytes);
+  sf->packed = malloc(sf->packedBytes);
+#else
+  sf->packedBytes = 0;
+  sf->packed = NULL;
+#endif
+  if (!sf->index || !sf->raw) nrerror("allocation failure in open_snapshots_2D()");
+
+  return sf;
+}
+
+static void add_index( snapshot_file *sf, snapshot_frame *frame, long offset )
+{
+  if (sf->count == sf->size)
+    {
+    sf->size *= 2;
+    sf->index = (snapshot_index *) realloc(sf->index, sf->size * sizeof(snapshot_index));
+    if (!sf->index) nrerror("allocation failure in write_snapshot_2D()");
+    }
+
+  sf->index[sf->count].label = frame->label;
+  sf->index[sf->count].nbytes = frame->nbytes;
+  sf->index[sf->count].time = frame->time;
+  sf->index[sf->count].offset = offset;
+  sf->count++;
+}
+
+/***************************************************************
+
+ open_snapshots_2D
+
+***************************************************************/
+
+snapshot_file *open_snapshots_2D( char *fname, int nx, int ny, int encoding )
+{
+  FILE *fp;
+  snapshot_file *sf;
+  snapshot_header hdr;
+
+  fp = fopen(fname, "wb");
+  if (!fp) nrerror("cannot open snapshot file");
+  sf = new_snapshot_file(fp, nx, ny, encoding);
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, SNAPSHOT_MAGIC, 8);
+  hdr.version = SNAPSHOT_VERSION;
+  hdr.nx = nx;
+  hdr.ny = ny;
+  hdr.encoding = encoding;
+#ifdef USE_ZLIB
+  hdr.compression = 1;
+#else
+  hdr.compression = 0;
+#endif
+  hdr.scale = SNAPSHOT_SCALE;
+  fwrite(&hdr, sizeof(hdr), 1, sf->fp);
+
+  return sf;
+}
+
+/***************************************************************
+
+ reopen_snapshots_2D
+
+ opens the snapshot file of the run a checkpoint came from, to
+ carry on adding to it. The index is rebuilt by reading the
+ frames from the start of the file, as in snapshot2stf, up to
+ offset bytes (the size of the file when the checkpoint was
+ written, or -1 if not known), and anything after them is
+ removed, including the index of a file that was closed. The
+ file is created if it does not exist.
+
+***************************************************************/
+
+snapshot_file *reopen_snapshots_2D( char *fname, int nx, int ny, int encoding, long offset )
+{
+  FILE *fp;
+  snapshot_file *sf;
+  snapshot_header hdr;
+  snapshot_trailer trailer;
+  snapshot_frame frame;
+  long end, pos;
+  int compression;
+
+  fp = fopen(fname, "r+b");
+  if (!fp)
+    return open_snapshots_2D(fname, nx, ny, encoding);
+
+  if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) || (memcmp(hdr.magic, SNAPSHOT_MAGIC, 8) != 0)
+    || (hdr.version != SNAPSHOT_VERSION))
+    nrerror("cannot add to snapshot file, it is not a snapshot file");
+#ifdef USE_ZLIB
+  compression = 1;
+#else
+  compression = 0;
+#endif
+  if ((hdr.nx != nx) || (hdr.ny != ny) || (hdr.encoding != encoding) || (hdr.compression != compression))
+    nrerror("cannot add to snapshot file, it has a different size or format");
+  sf = new_snapshot_file(fp, nx, ny, encoding);
+
+  /* the frames end at the index if the file was closed */
+  fseek(fp, 0, SEEK_END);
+  end = ftell(fp);
+  if (end >= (long) (sizeof(hdr) + sizeof(trailer)))
+    {
+    fseek(fp, end - sizeof(trailer), SEEK_SET);
+    if ((fread(&trailer, sizeof(trailer), 1, fp) == 1) && (memcmp(trailer.magic, SNAPSHOT_INDEX_MAGIC, 4) == 0)
+      && (trailer.offset + trailer.count * (long) sizeof(snapshot_index) + (long) sizeof(trailer) == end))
+      end = trailer.offset;
+    }
+  if ((offset >= 0) && (offset < end))
+    end = offset;
+
+  pos = sizeof(hdr);
+  fseek(fp, pos, SEEK_SET);
+  while ((fread(&frame, sizeof(frame), 1, fp) == 1) && (frame.nbytes > 0)
+    && (pos + (long) sizeof(frame) + frame.nbytes <= end))
+    {
+    add_index(sf, &frame, pos);
+    pos += sizeof(frame) + frame.nbytes;
+    fseek(fp, pos, SEEK_SET);
+    }
+
+  fseek(fp, pos, SEEK_SET);
+  if (ftruncate(fileno(fp), pos) != 0)
+    nrerror("cannot remove snapshots written after the checkpoint");
+  fseek(fp, pos, SEEK_SET);
+
+  printf("adding to %s after %d snapshots\n", fname, sf->count);
+  return sf;
+}
+
+/***************************************************************
+
+ write_snapshot_2D
+
+ appends Vm at time (ms) to the snapshot file, label is the
+ number that would have been used in the stf file name
+
+***************************************************************/
+
+void write_snapshot_2D( snapshot_file *sf, double *Vm, int **geomarray, int label, double time )
+{
+  int row, col, i, index;
+  double outdouble;
+  float *f = (float *) sf->raw;
+  int16_t *s = (int16_t *) sf->raw;
+  snapshot_frame frame;
+  void *data = sf->raw;
+  long nbytes = sf->rawBytes;
+
+  i = 0;
+  for (row = 1; row <= sf->ny; row++)
+    for (col = 1; col <= sf->nx; col++)
+      {
+      index = (geomarray[row][col] > 0)?geomarray[row][col]:0;
+      if (index > 0)
+          outdouble = Vm[index];
+      else
+          outdouble = -100.0;
+      if (sf->encoding == SNAPSHOT_INT16)
+        s[i++] = (int16_t) lrint(outdouble * SNAPSHOT_SCALE);
+      else
+        f[i++] = (float) outdouble;
+      }
+
+#ifdef USE_ZLIB
+  {
+  uLongf packed = sf->packedBytes;
+  if (compress2((Bytef *) sf->packed, &packed, (const Bytef *) sf->raw, sf->rawBytes, Z_BEST_SPEED) != Z_OK)
+    nrerror("failed to compress snapshot");
+  data = sf->packed;
+  nbytes = packed;
+  }
+#endif
+
+  frame.label = label;
+  frame.nbytes = nbytes;
+  frame.time = time;
+  add_index(sf, &frame, ftell(sf->fp));
+
+  fwrite(&frame, sizeof(frame), 1, sf->fp);
+  if (fwrite(data, 1, nbytes, sf->fp) != (size_t) nbytes)
+    nrerror("failed to write snapshot");
+}
+
+/***************************************************************
+
+ close_snapshots_2D
+
+ writes the index and closes the file
+
+***************************************************************/
+
+void close_snapshots_2D( snapshot_file *sf )
+{
+  snapshot_trailer trailer;
+
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.offset = ftell(sf->fp);
+  trailer.count = sf->count;
+  memcpy(trailer.magic, SNAPSHOT_INDEX_MAGIC, 4);
+
+  fwrite(sf->index, sizeof(snapshot_index), sf->count, sf->fp);
+  fwrite(&trailer, sizeof(trailer), 1, sf->fp);
+  fclose(sf->fp);
+
+  free(sf->index);
+  free(sf->raw);
+  free(sf->packed);
+  free(sf);
+}
@@ -1,17 +1,17 @@
 /***************************************************************
 
- checkpoint_read.c
+ state_2D.c
 
  Version       2.1
 
  Date          23-oct-2023
 
  Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
- 
+
  This file is part of VentricularFibrosis.
 
- Copyright (c) Richard Clayton, 
- Department of Computer Science, 
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
  University of Sheffield, 2006, 2009, 2016, 2023
 
  VentricularFibrosis is free software: you can redistribute it and/or modify
@@ -29,50 +29,48 @@
 
 *********************************************************************/
 
+#include "TP06_OpSplit_2D.h"
 
 /***************************************************************
 
-  reads parameter space from binary file "checkpointXXXX.out"
+ create_state_2D
+
+ allocates model state as a structure of arrays, with one
+ contiguous, aligned array per state variable indexed [1..N].
+ u->var[1] and u->Vm refer to the same array, so code that only
+ needs the membrane voltage (diffusion, output) touches 8 bytes
+ per node rather than the whole state.
 
 ***************************************************************/
-#include "TP06_OpSplit_2D.h"
 
-int checkpoint_read( double **u, double *time, int *t, int count, int N)
+state_2D *create_state_2D( int N )
+{
+  int m;
+  state_2D *u;
+
+  u = (state_2D *) malloc(sizeof(state_2D));
+  if (!u) nrerror("allocation failure in create_state_2D()");
+
+  u->N = N;
+  u->var[0] = NULL;
+  for (m = 1; m <= NUM_STATES; m++)
+    u->var[m] = avector(1, N);
+  u->Vm = u->var[1];
+
+  return u;
+}
+
+/***************************************************************
+
+ free_state_2D
+
+***************************************************************/
+
+void free_state_2D( state_2D *u )
 {
-  int elements_to_read, i;
-  int n, m, M;
-
-  double u_n_m;
-  char fname[80];
-
-  FILE *chkpt_file;
-
-  M = NUM_STATES;
-  sprintf( fname,"%s%06d.out",CHKPTROOT,count );
-  printf("opening checkpoint file %s\n",fname);
-  chkpt_file = fopen( fname, "rb" );
-
-  fread( time, sizeof(double),1,chkpt_file);
-  fread( t, sizeof(int),1,chkpt_file);
-
-  printf("read time = %g, t = %d\n",*time,*t);
-  elements_to_read = N * M;
-  printf("reading %d elements\n",elements_to_read);
-
-  i = 0;
-  u_n_m = 0.0;
-  for (n = 1; n <= N; n++)
-  {
-	for (m = 1; m <= M; m++)
-    {
-      i += fread( &u_n_m, sizeof(double), 1, chkpt_file );
-      u[n][m] = u_n_m;
-    }
-  }
-
-  printf("read %d elements\n", i);
-  if (ferror(chkpt_file)) perror("error reading data");
-
-  fclose(chkpt_file);
-  return (1);
+  int m;
+
+  for (m = 1; m <= NUM_STATES; m++)
+    free_avector(u->var[m], 1, u->N);
+  free(u);
 }
@@ -40,17 +40,17 @@
 
 ***************************************************************/
 
-int stfout_2D( double **u, int **geomarray, int stfcount, int nx, int ny )
+int stfout_2D( double *Vm, int **geomarray, int stfcount, int nx, int ny )
 {
   int lay, row, col;
   int index, outint;
   double outdouble;
-  char fname[80];
-  char gzipfile[80];
+  char fname[CONFIG_STRLEN + 16];
+  char gzipfile[CONFIG_STRLEN + 32];
 
   FILE *stf_file;
 
-  sprintf( fname,"%s%04d.stf",STFFILEROOT,stfcount );
+  sprintf( fname,"%s%04d.stf",config.stfRoot,stfcount );
 
   stf_file = fopen( fname, "w" );
 
@@ -67,7 +67,7 @@ int stfout_2D( double **u, int **geomarray, int stfcount, int nx, int ny )
       {
       index = (geomarray[row][col] > 0)?geomarray[row][col]:0;
       if (index > 0)
-          outdouble = u[index][1];
+          outdouble = Vm[index];
       else
           outdouble = -100.0;
       fprintf(stf_file, "%4.2f ", outdouble);
@@ -76,7 +76,7 @@ int stfout_2D( double **u, int **geomarray, int stfcount, int nx, int ny )
   }
   fclose( stf_file);
 
-  sprintf( gzipfile,"gzip %s",fname );
+  sprintf( gzipfile,"gzip -f %s",fname );
   if (system(gzipfile) == -1 ) nrerror("failed to gzip file\n");
 
   return (1);
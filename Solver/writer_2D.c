@@ -0,0 +1,360 @@
+/***************************************************************
+
+ writer_2D.c
+
+ Version       2.1
+
+ Date          23-oct-2023
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+#include "TP06_OpSplit_2D.h"
+
+/***************************************************************
+
+ Output from the main loop is handed to a background thread
+ through a queue of WRITER_QUEUE jobs, so that writing and
+ compressing snapshots, electrograms and checkpoints overlaps the
+ following time steps. Each job holds its own copy of the data.
+ The solver only waits if the queue is full, or if the previous
+ checkpoint has not yet been written, and jobs are written in the
+ order they were queued.
+
+***************************************************************/
+
+/* bytes written to the electrogram and snapshot files, once the */
+/* jobs before this one have been written */
+static void output_offsets( writer_2D *w, long *egOffset, long *snapOffset )
+{
+  fflush(w->egPtr);
+  *egOffset = ftell(w->egPtr);
+  *snapOffset = -1;
+  if (w->snap)
+    {
+    fflush(w->snap->fp);
+    *snapOffset = ftell(w->snap->fp);
+    }
+}
+
+/***************************************************************
+
+ keep_checkpoint_2D
+
+ adds checkpoint count to those kept, and removes the oldest once
+ there are more than keep. It is called for each checkpoint the
+ writer thread writes, and can be called before the first is
+ queued for checkpoints already on disk, such as the one a run
+ was restarted from, so that they are removed in turn.
+
+***************************************************************/
+
+void keep_checkpoint_2D( writer_2D *w, int count )
+{
+  char fname[CONFIG_STRLEN + 16];
+  int i;
+
+  i = w->numKept % w->keep;
+  if ((w->kept[i] >= 0) && (w->kept[i] != count))
+    {
+    sprintf(fname, "%s%06d.out", config.chkptRoot, w->kept[i]);
+    remove(fname);
+    }
+  w->kept[i] = count;
+  w->numKept++;
+}
+
+static void run_job( writer_2D *w, writer_job *job )
+{
+  double *v = job->value;
+  checkpoint_header hdr;
+  long egOffset, snapOffset;
+  int i;
+
+  switch (job->type)
+    {
+    case WRITER_ELECTROGRAM:
+      printf("time %f ms, writing electrograms to file\n", job->time);
+      for (i = 0; i < job->numValues; i++)
+        {
+        fprintf(w->egPtr, (i < job->numValues - 1) ? "%4.2f " : "%4.2f\n", v[i]);
+        printf((i < job->numValues - 1) ? "%4.2f " : "%4.2f\n", v[i]);
+        }
+      break;
+
+    case WRITER_SNAPSHOT:
+      printf("time %f ms, writing stffile\n", job->time);
+      if (w->snapshots == SNAPSHOT_STF)
+        stfout_2D( job->Vm, w->geom, job->label, w->ncols, w->nrows );
+      else
+        write_snapshot_2D( w->snap, job->Vm, w->geom, job->label, job->time );
+      break;
+
+    case WRITER_CHECKPOINT:
+      /* the output so far goes with the checkpoint */
+      output_offsets(w, &egOffset, &snapOffset);
+      memcpy(&hdr, w->chkBuf, sizeof(hdr));
+      hdr.egOffset = egOffset;
+      hdr.snapOffset = snapOffset;
+      memcpy(w->chkBuf, &hdr, sizeof(hdr));
+
+      if (checkpoint_flush( w->chkBuf, w->chkSize, job->label ))
+        {
+        printf("written checkpoint %s%06d.out at time %f ms\n", config.chkptRoot, job->label, job->time);
+
+        keep_checkpoint_2D(w, job->label);
+        }
+      break;
+    }
+}
+
+static void *writer_thread( void *arg )
+{
+  writer_2D *w = (writer_2D *) arg;
+  writer_job *job;
+
+  pthread_mutex_lock(&w->lock);
+  while (1)
+    {
+    while ((w->count == 0) && !w->done)
+      pthread_cond_wait(&w->notEmpty, &w->lock);
+    if (w->count == 0)
+      break;
+
+    /* write without holding the lock, the slot stays taken until done */
+    job = &w->job[w->head];
+    pthread_mutex_unlock(&w->lock);
+    run_job(w, job);
+    pthread_mutex_lock(&w->lock);
+
+    if (job->type == WRITER_CHECKPOINT)
+      w->chkBusy = 0;
+    w->head = (w->head + 1) % WRITER_QUEUE;
+    w->count--;
+    pthread_cond_signal(&w->notFull);
+    }
+  pthread_mutex_unlock(&w->lock);
+
+  return NULL;
+}
+
+/***************************************************************
+
+ create_writer_2D
+
+ starts the writer thread. egPtr is the electrogram file, and
+ snap the binary snapshot file (NULL when writing stf files).
+ keep is the number of checkpoints kept.
+
+***************************************************************/
+
+writer_2D *create_writer_2D( int N, int **geom, int nrows, int ncols, FILE *egPtr, snapshot_file *snap, int snapshots, int keep )
+{
+  int i;
+  writer_2D *w;
+
+  w = (writer_2D *) malloc(sizeof(writer_2D));
+  if (!w) nrerror("allocation failure in create_writer_2D()");
+
+  w->N = N;
+  w->geom = geom;
+  w->nrows = nrows;
+  w->ncols = ncols;
+  w->egPtr = egPtr;
+  w->snap = snap;
+  w->snapshots = snapshots;
+  w->head = 0;
+  w->count = 0;
+  w->done = 0;
+  for (i = 0; i < WRITER_QUEUE; i++)
+    w->job[i].Vm = fvector(1, N);
+
+  w->chkBuf = NULL;
+  w->chkSize = 0;
+  w->chkBusy = 0;
+  w->keep = (keep > 0) ? keep : 1;
+  w->numKept = 0;
+  w->kept = ivector(0, w->keep - 1);
+  for (i = 0; i < w->keep; i++)
+    w->kept[i] = -1;
+
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->notEmpty, NULL);
+  pthread_cond_init(&w->notFull, NULL);
+  if (pthread_create(&w->thread, NULL, writer_thread, w) != 0)
+    nrerror("cannot start writer thread");
+
+  return w;
+}
+
+/***************************************************************
+
+ next_job and queue_job
+
+ next_job waits for a free slot and returns it to be filled in,
+ queue_job passes it to the writer thread
+
+***************************************************************/
+
+static writer_job *next_job( writer_2D *w )
+{
+  writer_job *job;
+
+  pthread_mutex_lock(&w->lock);
+  while (w->count == WRITER_QUEUE)
+    pthread_cond_wait(&w->notFull, &w->lock);
+  job = &w->job[(w->head + w->count) % WRITER_QUEUE];
+  pthread_mutex_unlock(&w->lock);
+
+  return job;
+}
+
+static void queue_job( writer_2D *w )
+{
+  pthread_mutex_lock(&w->lock);
+  w->count++;
+  pthread_cond_signal(&w->notEmpty);
+  pthread_mutex_unlock(&w->lock);
+}
+
+/***************************************************************
+
+ queue_electrogram_2D
+
+ value[0..num-1], Vm at each probe, are written to the
+ electrogram file and to the screen
+
+***************************************************************/
+
+void queue_electrogram_2D( writer_2D *w, double time, double *value, int num )
+{
+  int i;
+  writer_job *job = next_job(w);
+
+  job->type = WRITER_ELECTROGRAM;
+  job->time = time;
+  job->numValues = num;
+  for (i = 0; i < num; i++)
+    job->value[i] = value[i];
+  queue_job(w);
+}
+
+/***************************************************************
+
+ queue_snapshot_2D
+
+***************************************************************/
+
+void queue_snapshot_2D( writer_2D *w, double *Vm, int label, double time )
+{
+  writer_job *job = next_job(w);
+
+  job->type = WRITER_SNAPSHOT;
+  job->time = time;
+  job->label = label;
+  memcpy(&job->Vm[1], &Vm[1], w->N * sizeof(double));
+  queue_job(w);
+}
+
+/***************************************************************
+
+ queue_checkpoint_2D
+
+ copies the solver state into the checkpoint buffer, and the
+ writer thread writes it to "checkpointXXXXXX.out". There is one
+ buffer, so this waits until the last checkpoint has been written.
+
+***************************************************************/
+
+void queue_checkpoint_2D( writer_2D *w, checkpoint_2D *c, int count )
+{
+  writer_job *job;
+
+  pthread_mutex_lock(&w->lock);
+  while (w->chkBusy)
+    pthread_cond_wait(&w->notFull, &w->lock);
+  w->chkBusy = 1;
+  pthread_mutex_unlock(&w->lock);
+
+  if (!w->chkBuf)
+    {
+    w->chkSize = checkpoint_size(c);
+    w->chkBuf = (char *) malloc(w->chkSize);
+    if (!w->chkBuf) nrerror("allocation failure in queue_checkpoint_2D()");
+    }
+  checkpoint_pack(c, w->chkBuf);
+
+  job = next_job(w);
+  job->type = WRITER_CHECKPOINT;
+  job->time = c->time;
+  job->label = count;
+  queue_job(w);
+}
+
+/***************************************************************
+
+ writer_offsets_2D
+
+ waits for the jobs queued so far to be written, and sets the
+ sizes of the electrogram and snapshot files in c, for a
+ checkpoint written by the solver itself
+
+***************************************************************/
+
+void writer_offsets_2D( writer_2D *w, checkpoint_2D *c )
+{
+  pthread_mutex_lock(&w->lock);
+  while (w->count > 0)
+    pthread_cond_wait(&w->notFull, &w->lock);
+  pthread_mutex_unlock(&w->lock);
+
+  output_offsets(w, &c->egOffset, &c->snapOffset);
+}
+
+/***************************************************************
+
+ free_writer_2D
+
+ waits for the queue to empty, and stops the writer thread
+
+***************************************************************/
+
+void free_writer_2D( writer_2D *w )
+{
+  int i;
+
+  pthread_mutex_lock(&w->lock);
+  w->done = 1;
+  pthread_cond_signal(&w->notEmpty);
+  pthread_mutex_unlock(&w->lock);
+  pthread_join(w->thread, NULL);
+
+  pthread_mutex_destroy(&w->lock);
+  pthread_cond_destroy(&w->notEmpty);
+  pthread_cond_destroy(&w->notFull);
+  for (i = 0; i < WRITER_QUEUE; i++)
+    free_fvector(w->job[i].Vm, 1, w->N);
+  free_ivector(w->kept, 0, w->keep - 1);
+  free(w->chkBuf);
+  free(w);
+}
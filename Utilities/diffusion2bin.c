@@ -0,0 +1,169 @@
+/********************************************************************
+
+ diffusion2bin.c
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/* diffusion2bin : converts a DiffusionCoefficient.txt file into the
+   binary diffusion file read by the simulation code
+   (diffusion_file_2D.c), or checks a binary file
+
+   gcc -O2 -o diffusion2bin diffusion2bin.c -lm
+
+   diffusion2bin <text file> <rows> <cols> <binary file>
+   diffusion2bin <binary file>                        (check only)
+
+   The structure below must match TP06_OpSplit_2D.h */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define DIFFUSION_MAGIC "TP06DIFF"
+#define DIFFUSION_VERSION 1
+
+typedef struct
+{
+  char magic[8];
+  int32_t version;
+  int32_t nrows, ncols;
+  int32_t reserved;
+  uint64_t hash;
+} diffusion_header;
+
+void error( char *text )
+{
+  fprintf(stderr, "diffusion2bin: %s\n", text);
+  exit(1);
+}
+
+/* 64 bit FNV-1a hash, as hash_data_2D() */
+uint64_t hash_data( void *data, long size )
+{
+  uint64_t hash = 14695981039346656037ULL;
+  unsigned char *buf = (unsigned char *) data;
+  long i;
+
+  for (i = 0; i < size; i++)
+    {
+    hash ^= buf[i];
+    hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+int check( char *fname )
+{
+  diffusion_header hdr;
+  float *data, dmin, dmax;
+  long RC, n, size;
+  FILE *fp;
+
+  fp = fopen(fname, "rb");
+  if (!fp)
+    error("cannot open binary file");
+  if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) || (memcmp(hdr.magic, DIFFUSION_MAGIC, 8) != 0))
+    error("not a binary diffusion file");
+  if (hdr.version != DIFFUSION_VERSION)
+    error("unknown version");
+
+  RC = (long) hdr.nrows * hdr.ncols;
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  if (size != (long) sizeof(hdr) + RC * (long) sizeof(float))
+    error("file has the wrong size");
+
+  data = (float *) malloc(RC * sizeof(float));
+  fseek(fp, sizeof(hdr), SEEK_SET);
+  if (fread(data, sizeof(float), RC, fp) != (size_t) RC)
+    error("cannot read data");
+  fclose(fp);
+  if (hash_data(data, RC * sizeof(float)) != hdr.hash)
+    error("file is corrupt (hash does not match)");
+
+  dmin = dmax = data[0];
+  for (n = 0; n < RC; n++)
+    {
+    if (!isfinite(data[n]))
+      error("file holds a value that is not a number");
+    if (data[n] < dmin) dmin = data[n];
+    if (data[n] > dmax) dmax = data[n];
+    }
+  printf("%d x %d, D from %g to %g\n", hdr.nrows, hdr.ncols, dmin, dmax);
+
+  free(data);
+  return 0;
+}
+
+int main( int argc, char **argv )
+{
+  diffusion_header hdr;
+  float *data;
+  long RC, n;
+  int nrows, ncols;
+  FILE *fp;
+
+  if (argc == 2)
+    return check(argv[1]);
+  if (argc != 5)
+    error("usage: diffusion2bin <text file> <rows> <cols> <binary file>");
+
+  nrows = atoi(argv[2]);
+  ncols = atoi(argv[3]);
+  if ((nrows < 1) || (ncols < 1))
+    error("rows and cols must be positive");
+  RC = (long) nrows * ncols;
+
+  fp = fopen(argv[1], "r");
+  if (!fp)
+    error("cannot open text file");
+  data = (float *) malloc(RC * sizeof(float));
+  for (n = 0; n < RC; n++)
+    if ((fscanf(fp, "%f ", &data[n]) != 1) || !isfinite(data[n]))
+      {
+      fprintf(stderr, "row %ld column %ld: ", n / ncols + 1, n % ncols + 1);
+      error(feof(fp) ? "end of file" : "not a number");
+      }
+  fclose(fp);
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, DIFFUSION_MAGIC, 8);
+  hdr.version = DIFFUSION_VERSION;
+  hdr.nrows = nrows;
+  hdr.ncols = ncols;
+  hdr.hash = hash_data(data, RC * sizeof(float));
+
+  fp = fopen(argv[4], "wb");
+  if (!fp)
+    error("cannot open binary file");
+  if ((fwrite(&hdr, sizeof(hdr), 1, fp) != 1) || (fwrite(data, sizeof(float), RC, fp) != (size_t) RC))
+    error("cannot write binary file");
+  if (fclose(fp) != 0)
+    error("cannot write binary file");
+
+  free(data);
+  return 0;
+}
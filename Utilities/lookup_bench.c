@@ -0,0 +1,328 @@
+/********************************************************************
+
+ lookup_bench.c
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/* lookup_bench : compares the gate lookups of the reaction stage with
+   the table held as one row per variable (as before) and as one record
+   per voltage bin and sub-step (create_lookup_2D()), and reports the
+   time, the cache lines read and the L1 and last level cache misses
+   per node, for nodes along a row of tissue with an action potential
+   passing through them
+
+   gcc -O2 -o lookup_bench lookup_bench.c -lm
+   lookup_bench [nodes] [repeats] [dt]
+
+   Add -DLOOKUP_FLOAT for single precision records. The cache misses
+   are counted with perf_event_open() on Linux, and are not shown if
+   the counters cannot be opened (see perf_event_paranoid).
+
+   The sizes below must match TP06_OpSplit_2D.h */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define NUM_GATES       11
+#define NUM_LOOKUP      40
+#define VOLTAGE_STEPS   2001
+#define GAIN            10
+#define VMOFFSET        1001
+#define LOOKUP_VMIN     -100
+#define LOOKUP_BINS     201
+#define ALIGNMENT       64
+#define WAVELENGTH      2000    /* nodes from one wavefront to the next */
+
+#ifdef LOOKUP_FLOAT
+typedef float lookup_t;
+#else
+typedef double lookup_t;
+#endif
+#define LOOKUP_RECORD   ((int) ((2 * NUM_GATES * sizeof(lookup_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT / sizeof(lookup_t)))
+
+/* rows of the inf and tau tables, as create_TP06_lookup_OpSplit_2D() */
+const int infRow[NUM_GATES] = { 6, 2, 4, 8, 10, 12, 14, 16, 18, 19, 21 };
+const int tauRow[NUM_GATES] = { 5, 1, 3, 7, 9, 11, 13, 15, 17, 20, 22 };
+
+void error( char *text )
+{
+  fprintf(stderr, "lookup_bench: %s\n", text);
+  exit(1);
+}
+
+void *aligned( size_t size )
+{
+  void *p = NULL;
+
+  if (posix_memalign(&p, ALIGNMENT, size) != 0)
+    error("allocation failure");
+  memset(p, 0, size);
+  return p;
+}
+
+double now( void )
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/* hardware cache miss counters */
+#ifdef __linux__
+int open_counter( uint64_t config, int group )
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = config;
+  attr.disabled = (group < 0);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+int open_counters( int *fd )
+{
+  const uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  fd[0] = open_counter(PERF_COUNT_HW_CACHE_L1D | read_miss, -1);
+  if (fd[0] < 0)
+    return 0;
+  fd[1] = open_counter(PERF_COUNT_HW_CACHE_LL | read_miss, fd[0]);
+  return 1;
+}
+
+void start_counters( int *fd )
+{
+  ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void stop_counters( int *fd, double *count )
+{
+  uint64_t value;
+  int i;
+
+  ioctl(fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  for (i = 0; i < 2; i++)
+    count[i] = ((fd[i] >= 0) && (read(fd[i], &value, sizeof(value)) == sizeof(value))) ? (double) value : -1.0;
+}
+#else
+int open_counters( int *fd ) { return 0; }
+void start_counters( int *fd ) { }
+void stop_counters( int *fd, double *count ) { }
+#endif
+
+/* action potential at phase 0..1 of the cycle, and the sub-step used */
+/* there by the adaptive time step (more during the upstroke) */
+double action_potential( double phase, int numK, int *k )
+{
+  *k = 1;
+  if (phase < 0.01)
+    {
+    *k = numK;
+    return -86.0 + 116.0 * phase / 0.01;
+    }
+  if (phase < 0.35)
+    return 30.0 - 30.0 * (phase - 0.01) / 0.34;
+  if (phase < 0.45)
+    {
+    *k = 2;
+    return -86.0 * (phase - 0.35) / 0.10;
+    }
+  return -86.0 + 0.5 * sin(40.0 * phase);
+}
+
+/* Rush-Larsen update of the gates with the tables one row per variable, */
+/* reading inf and exp(-dt/tau) as calculate_TP06_current_OpSplit_block() did */
+void update_rows( double **rows, int numK, long N, const double *Vm, const int *k, double **gate )
+{
+  long n;
+  int g, Vindex;
+  double inf;
+
+  for (n = 0; n < N; n++)
+    {
+    Vindex = (int) floor(Vm[n]) * GAIN + VMOFFSET;
+    for (g = 0; g < NUM_GATES; g++)
+      {
+      inf = rows[infRow[g]][Vindex];
+      gate[g][n] = inf - (inf - gate[g][n]) * rows[NUM_LOOKUP + 1 + g*numK + k[n] - 1][Vindex];
+      }
+    }
+}
+
+/* the same with one record per voltage bin and sub-step */
+void update_records( const lookup_t *table, long N, const double *Vm, const int *k, double **gate )
+{
+  const lookup_t *rec;
+  long n;
+  int g, bin;
+  double inf;
+
+  for (n = 0; n < N; n++)
+    {
+    bin = (int) floor(Vm[n]) - LOOKUP_VMIN;
+    bin = (bin < 0) ? 0 : ((bin >= LOOKUP_BINS) ? LOOKUP_BINS - 1 : bin);
+    rec = &table[((long) (k[n] - 1) * LOOKUP_BINS + bin) * LOOKUP_RECORD];
+    for (g = 0; g < NUM_GATES; g++)
+      {
+      inf = rec[2*g];
+      gate[g][n] = inf - (inf - gate[g][n]) * rec[2*g + 1];
+      }
+    }
+}
+
+int main( int argc, char **argv )
+{
+  long N = (argc > 1) ? atol(argv[1]) : 1000000;
+  int repeats = (argc > 2) ? atoi(argv[2]) : 20;
+  double dt = (argc > 3) ? atof(argv[3]) : 0.1;
+  int numK, numRows, g, kk, bin, Vindex, r, layout, counters, fd[2];
+  long n, rowsBytes, recordBytes;
+  double **rows, *rowData, *Vm, **gate, **result, V, tau, t, best[2], miss[2][2], count[2], diff;
+  lookup_t *table, *rec;
+  int *k;
+
+  if ((N < 1) || (repeats < 1) || (dt <= 0.0))
+    error("usage: lookup_bench [nodes] [repeats] [dt]");
+  numK = (int) ceil(dt/0.01);
+
+  /* both layouts, with made up inf and tau that depend on Vm */
+  numRows = NUM_LOOKUP + 1 + NUM_GATES * numK;
+  rowsBytes = (long) numRows * (VOLTAGE_STEPS + 1) * sizeof(double);
+  rowData = (double *) aligned(rowsBytes);
+  rows = (double **) malloc(numRows * sizeof(double *));
+  for (r = 0; r < numRows; r++)
+    rows[r] = &rowData[(long) r * (VOLTAGE_STEPS + 1)];
+
+  recordBytes = (long) numK * LOOKUP_BINS * LOOKUP_RECORD * sizeof(lookup_t);
+  table = (lookup_t *) aligned(recordBytes);
+
+  for (bin = 0; bin < LOOKUP_BINS; bin++)
+    {
+    V = bin + LOOKUP_VMIN;
+    Vindex = (int) V * GAIN + VMOFFSET;
+    for (g = 0; g < NUM_GATES; g++)
+      {
+      rows[infRow[g]][Vindex] = 1.0/(1.0 + exp(-(V + 5.0*g)/7.0));
+      rows[tauRow[g]][Vindex] = tau = 1.0 + g + 10.0*exp(-(V + 40.0)*(V + 40.0)/1800.0);
+      for (kk = 1; kk <= numK; kk++)
+        {
+        rows[NUM_LOOKUP + 1 + g*numK + kk - 1][Vindex] = exp(-(dt/kk)/tau);
+        rec = &table[((long) (kk - 1) * LOOKUP_BINS + bin) * LOOKUP_RECORD];
+        rec[2*g] = (lookup_t) rows[infRow[g]][Vindex];
+        rec[2*g + 1] = (lookup_t) exp(-(dt/kk)/tau);
+        }
+      }
+    }
+
+  /* nodes along a row of tissue, with a wavefront every WAVELENGTH nodes */
+  Vm = (double *) aligned(N * sizeof(double));
+  k = (int *) aligned(N * sizeof(int));
+  gate = (double **) malloc(NUM_GATES * sizeof(double *));
+  result = (double **) malloc(NUM_GATES * sizeof(double *));
+  for (g = 0; g < NUM_GATES; g++)
+    {
+    gate[g] = (double *) aligned(N * sizeof(double));
+    result[g] = (double *) aligned(N * sizeof(double));
+    }
+  for (n = 0; n < N; n++)
+    Vm[n] = action_potential((n % WAVELENGTH) / (double) WAVELENGTH, numK, &k[n]);
+
+  printf("%ld nodes, dt %g ms, %d sub-steps, %s precision records\n", N, dt, numK,
+         (sizeof(lookup_t) == sizeof(float)) ? "single" : "double");
+  printf("rows    : %d rows of %d, %.0f kB, %d cache lines read per node\n",
+         numRows, VOLTAGE_STEPS + 1, rowsBytes / 1024.0, 2 * NUM_GATES);
+  printf("records : %d records of %d, %.0f kB, %d cache lines read per node\n",
+         numK * LOOKUP_BINS, LOOKUP_RECORD, recordBytes / 1024.0,
+         (int) (LOOKUP_RECORD * sizeof(lookup_t) / ALIGNMENT));
+
+  counters = open_counters(fd);
+  for (layout = 0; layout < 2; layout++)
+    {
+    best[layout] = 1.0e30;
+    miss[layout][0] = miss[layout][1] = 1.0e30;
+    for (r = 0; r < repeats; r++)
+      {
+      for (g = 0; g < NUM_GATES; g++)
+        for (n = 0; n < N; n++)
+          gate[g][n] = 0.5;
+      if (counters)
+        start_counters(fd);
+      t = now();
+      if (layout == 0)
+        update_rows(rows, numK, N, Vm, k, gate);
+      else
+        update_records(table, N, Vm, k, gate);
+      t = now() - t;
+      if (counters)
+        {
+        stop_counters(fd, count);
+        if (count[0] < miss[layout][0]) miss[layout][0] = count[0];
+        if (count[1] < miss[layout][1]) miss[layout][1] = count[1];
+        }
+      if (t < best[layout])
+        best[layout] = t;
+      }
+
+    /* keep the results of the first layout to check the second */
+    if (layout == 0)
+      for (g = 0; g < NUM_GATES; g++)
+        memcpy(result[g], gate[g], N * sizeof(double));
+    }
+
+  diff = 0.0;
+  for (g = 0; g < NUM_GATES; g++)
+    for (n = 0; n < N; n++)
+      if (fabs(gate[g][n] - result[g][n]) > diff)
+        diff = fabs(gate[g][n] - result[g][n]);
+
+  printf("\n           ns/node   L1D misses/node   LLC misses/node\n");
+  for (layout = 0; layout < 2; layout++)
+    {
+    printf("%-8s %9.2f", (layout == 0) ? "rows" : "records", 1.0e9 * best[layout] / N);
+    if (counters)
+      printf(" %17.2f %17.3f\n", miss[layout][0] / N, miss[layout][1] / N);
+    else
+      printf("               n/a               n/a\n");
+    }
+  printf("\nlargest difference between the layouts %g\n", diff);
+
+  return 0;
+}
@@ -0,0 +1,247 @@
+/********************************************************************
+
+ snapshot2stf.c
+
+ Author        R.H.Clayton (r.h.clayton@sheffield.ac.uk)
+
+ This file is part of VentricularFibrosis.
+
+ Copyright (c) Richard Clayton,
+ Department of Computer Science,
+ University of Sheffield, 2006, 2009, 2016, 2023
+
+ VentricularFibrosis is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*********************************************************************/
+
+/* snapshot2stf : converts a binary snapshot file written by the
+   simulation code (snapshot_2D.c) into one stf file per snapshot,
+   <stfroot>XXXX.stf, in the layout read by ReadStf.m
+
+   gcc -O2 -o snapshot2stf snapshot2stf.c
+   gcc -O2 -DUSE_ZLIB -o snapshot2stf snapshot2stf.c -lz   (for compressed files)
+
+   snapshot2stf <snapshot file> <stfroot>
+   snapshot2stf <snapshot file>                            (list snapshots only)
+
+   The structures below must match TP06_OpSplit_2D.h */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#define SNAPSHOT_FLOAT  1
+#define SNAPSHOT_INT16  2
+
+typedef struct
+{
+  char magic[8];
+  int32_t version;
+  int32_t nx, ny;
+  int32_t encoding;
+  int32_t compression;
+  int32_t reserved;
+  double scale;
+} snapshot_header;
+
+typedef struct
+{
+  int32_t label;
+  int32_t nbytes;
+  double time;
+} snapshot_frame;
+
+typedef struct
+{
+  int32_t label;
+  int32_t nbytes;
+  double time;
+  int64_t offset;
+} snapshot_index;
+
+typedef struct
+{
+  int64_t offset;
+  int32_t count;
+  char magic[4];
+} snapshot_trailer;
+
+void error( char *text )
+{
+  fprintf(stderr, "snapshot2stf: %s\n", text);
+  exit(1);
+}
+
+/* reads the index from the end of the file, or if the run did not
+   finish and there is no index, builds it by reading each frame */
+snapshot_index *read_index( FILE *fp, long dataStart, int *count )
+{
+  snapshot_trailer trailer;
+  snapshot_frame frame;
+  snapshot_index *index;
+  long end, pos;
+  int size = 64;
+
+  fseek(fp, 0, SEEK_END);
+  end = ftell(fp);
+
+  if (end >= dataStart + (long) sizeof(trailer))
+    {
+    fseek(fp, end - sizeof(trailer), SEEK_SET);
+    if ((fread(&trailer, sizeof(trailer), 1, fp) == 1) && (memcmp(trailer.magic, "INDX", 4) == 0)
+      && (trailer.offset + trailer.count * (long) sizeof(snapshot_index) + (long) sizeof(trailer) == end))
+      {
+      index = (snapshot_index *) malloc((trailer.count + 1) * sizeof(snapshot_index));
+      fseek(fp, trailer.offset, SEEK_SET);
+      if (fread(index, sizeof(snapshot_index), trailer.count, fp) != (size_t) trailer.count)
+        error("cannot read index");
+      *count = trailer.count;
+      return index;
+      }
+    }
+
+  printf("no index, reading snapshots one by one\n");
+  index = (snapshot_index *) malloc(size * sizeof(snapshot_index));
+  *count = 0;
+  pos = dataStart;
+  fseek(fp, pos, SEEK_SET);
+  while ((fread(&frame, sizeof(frame), 1, fp) == 1) && (frame.nbytes > 0)
+    && (pos + (long) sizeof(frame) + frame.nbytes <= end))
+    {
+    if (*count == size)
+      {
+      size *= 2;
+      index = (snapshot_index *) realloc(index, size * sizeof(snapshot_index));
+      }
+    index[*count].label = frame.label;
+    index[*count].nbytes = frame.nbytes;
+    index[*count].time = frame.time;
+    index[*count].offset = pos;
+    (*count)++;
+    pos += sizeof(frame) + frame.nbytes;
+    fseek(fp, pos, SEEK_SET);
+    }
+
+  return index;
+}
+
+int main( int argc, char **argv )
+{
+  FILE *fp, *stf_file;
+  snapshot_header hdr;
+  snapshot_index *index;
+  snapshot_frame frame;
+  int count, i, row, col, k;
+  long rawBytes;
+  void *raw, *packed;
+  float *f;
+  int16_t *s;
+  double outdouble;
+  char fname[256];
+
+  if (argc < 2)
+    error("usage: snapshot2stf <snapshot file> [<stfroot>]");
+
+  fp = fopen(argv[1], "rb");
+  if (!fp)
+    error("cannot open snapshot file");
+
+  if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) || (memcmp(hdr.magic, "TP06SNAP", 8) != 0))
+    error("not a snapshot file");
+  if (hdr.version != 1)
+    error("unknown snapshot file version");
+  if ((hdr.encoding != SNAPSHOT_FLOAT) && (hdr.encoding != SNAPSHOT_INT16))
+    error("unknown encoding");
+#ifndef USE_ZLIB
+  if (hdr.compression)
+    error("file is compressed, rebuild with -DUSE_ZLIB and -lz");
+#endif
+
+  rawBytes = (long) hdr.nx * hdr.ny * ((hdr.encoding == SNAPSHOT_INT16) ? sizeof(int16_t) : sizeof(float));
+  raw = malloc(rawBytes);
+  f = (float *) raw;
+  s = (int16_t *) raw;
+
+  index = read_index(fp, sizeof(hdr), &count);
+  printf("%d x %d, %s%s, %d snapshots\n", hdr.nx, hdr.ny,
+    (hdr.encoding == SNAPSHOT_INT16) ? "16 bit" : "float", hdr.compression ? ", compressed" : "", count);
+
+  for (i = 0; i < count; i++)
+    {
+    if (argc < 3)
+      {
+      printf("%4d  time %10.3f ms  label %04d\n", i, index[i].time, index[i].label);
+      continue;
+      }
+
+    fseek(fp, index[i].offset, SEEK_SET);
+    if (fread(&frame, sizeof(frame), 1, fp) != 1)
+      error("cannot read snapshot");
+    packed = malloc(frame.nbytes);
+    if (fread(packed, 1, frame.nbytes, fp) != (size_t) frame.nbytes)
+      error("cannot read snapshot");
+
+    if (hdr.compression)
+      {
+#ifdef USE_ZLIB
+      uLongf n = rawBytes;
+      if ((uncompress((Bytef *) raw, &n, (const Bytef *) packed, frame.nbytes) != Z_OK) || (n != (uLongf) rawBytes))
+        error("cannot uncompress snapshot");
+#endif
+      }
+    else if (frame.nbytes == rawBytes)
+      memcpy(raw, packed, rawBytes);
+    else
+      error("snapshot has the wrong size");
+    free(packed);
+
+    sprintf(fname, "%s%04d.stf", argv[2], frame.label);
+    stf_file = fopen(fname, "w");
+    if (!stf_file)
+      error("cannot open stf file");
+
+    fprintf(stf_file, "NAME Vm\n");
+    fprintf(stf_file, "RANK 2\n");
+    fprintf(stf_file, "DIMENSIONS %d %d\n", hdr.nx, hdr.ny);
+    fprintf(stf_file, "BOUNDS %d %d %d %d\n", 0, hdr.nx-1, 0, hdr.ny-1);
+    fprintf(stf_file, "SCALAR\n");
+    fprintf(stf_file, "DATA\n");
+
+    k = 0;
+    for (row = 1; row <= hdr.ny; row++)
+      {
+      for (col = 1; col <= hdr.nx; col++)
+        {
+        if (hdr.encoding == SNAPSHOT_INT16)
+          outdouble = s[k++] / hdr.scale;
+        else
+          outdouble = f[k++];
+        fprintf(stf_file, "%4.2f ", outdouble);
+        }
+      fprintf(stf_file, "\n");
+      }
+    fclose(stf_file);
+    }
+
+  free(index);
+  free(raw);
+  fclose(fp);
+
+  return 0;
+}